@@ -15,6 +15,31 @@
 
 namespace Pomerol{
 
+/** An operator, which is diagonal in the FockState basis : a linear combination of the products of the occupation numbers,
+ * e.g. \f$ n_i \f$, \f$ n_i n_j \f$ or \f$ S^z_i S^z_j \f$. Several such operators are measured together by DensityMatrix::getAverages.
+ */
+struct DiagonalObservable
+{
+    /** A product of the occupation numbers, given by their indices, and its coefficient. */
+    typedef std::pair<std::vector<ParticleIndex>, RealType> Term;
+    /** The terms of the operator. */
+    std::vector<Term> Terms;
+
+    /** Adds a product of the occupation numbers.
+     * \param[in] Indices The indices of the occupation numbers.
+     * \param[in] Coefficient The coefficient of the product. */
+    DiagonalObservable& add(const std::vector<ParticleIndex>& Indices, RealType Coefficient = 1.0);
+    /** Adds the terms of another operator. */
+    DiagonalObservable& operator+=(const DiagonalObservable& rhs);
+
+    /** Returns the occupation number \f$ n_i \f$. */
+    static DiagonalObservable Occupancy(ParticleIndex i);
+    /** Returns the product \f$ n_i n_j \f$. */
+    static DiagonalObservable DoubleOccupancy(ParticleIndex i, ParticleIndex j);
+    /** Returns the product \f$ S^z_a S^z_b \f$ of the spins \f$ S^z = (n_\uparrow - n_\downarrow)/2 \f$ of two sites. */
+    static DiagonalObservable SzSz(ParticleIndex UpA, ParticleIndex DownA, ParticleIndex UpB, ParticleIndex DownB);
+};
+
 /** This class represents a density matrix \f$ \rho = \exp(-\beta \hat H)/Z \f$.
  * It is actually a container class for a collection of parts (all real calculations
  * take place inside the parts). There is one-to-one correspondence between parts of
@@ -46,6 +71,10 @@ public:
     /** Actually computes the parts. */
     void compute(void);
 
+    /** Recomputes the weights after the Hamiltonian has been updated and computed again.
+     * The parts and the truncation of the blocks are kept. */
+    void update(void);
+
     /** Returns a part of the density matrix.
     * \param[in] in A set of the quantum numbers to be resolved into a part number.
     */
@@ -69,6 +98,17 @@ public:
 
     /** Returns an averaged value of the double occupancy. */
     RealType getAverageDoubleOccupancy(ParticleIndex i, ParticleIndex j) const;
+    /** Returns the averages of several operators, which are diagonal in the FockState basis, in a single pass over the eigenvectors.
+     * The distinct products of the occupation numbers of all operators are measured together in every part, see DensityMatrixPart::getAverageProducts.
+     * \param[in] Observables The operators. */
+    std::vector<RealType> getAverages(const std::vector<DiagonalObservable>& Observables) const;
+    /** Returns the one-body density matrix \f$ \langle c^+_i c_j \rangle \f$ for all pairs of indices. 
+     * The annihilation operators are applied to the eigenvectors of every part, see DensityMatrixPart::getOverlapAverages. */
+    MatrixType getOneBodyDensityMatrix(void) const;
+    /** Returns the two-body density matrix \f$ \langle c^+_i c^+_j c_l c_k \rangle \f$ for the pairs p = (i,j) and q = (k,l) 
+     * of a given list, the element (p,q) of the result. 
+     * \param[in] Pairs The pairs of indices. */
+    MatrixType getTwoBodyDensityMatrix(const std::vector<IndexCombination2>& Pairs) const;
 
     /** Truncate such blocks that do not include any states having larger weight than Tolerance. */
     void truncateBlocks(RealType Tolerance, bool verbose=true);
@@ -9,6 +9,7 @@
 
 #include "Thermal.h"
 #include "HamiltonianPart.h"
+#include "Operator.h"
 
 namespace Pomerol{
 
@@ -39,6 +40,16 @@ class DensityMatrixPart : public Thermal
 
     /** It is true if this part has not been truncated. */
     bool retained;
+    /** The states, which have not been truncated, in ascending order. All states by default. */
+    std::vector<InnerQuantumState> RetainedStates;
+    /** It is true for the states in RetainedStates. */
+    std::vector<bool> StateRetained;
+
+    /** Returns the thermal average of an operator, which is diagonal in the FockState basis. 
+     * \param[in] Values The diagonal of the operator in the FockStates of the part. */
+    RealType getAverageDiagonal(const RealVectorType& Values) const;
+
+    friend class DensityMatrix;
 
 public:
     /** Constructor.
@@ -73,15 +84,35 @@ public:
     RealType getAverageOccupancy(ParticleIndex i) const;
     /** Returns an averaged value of the double occupancy. */
     RealType getAverageDoubleOccupancy(ParticleIndex i, ParticleIndex j) const;
+    /** Returns the thermal weights of the FockStates of the part, \f$ p_f = \sum_s w_s |U_{fs}|^2 \f$. 
+     * They are a single product of the matrix \f$ |U|^2 \f$ and the vector of the weights, the eigenvectors are read in place. */
+    RealVectorType getFockStateWeights(void) const;
+    /** Returns the contributions of the part to the averages of several products of the occupation numbers.
+     * The pattern of the products in the FockStates of the part, a matrix of 0 and 1, is multiplied by the weights of the FockStates, 
+     * so all products are measured in a single pass over the eigenvectors.
+     * \param[in] Masks The products, each given by a FockState, where the bits of its occupation numbers are set. */
+    RealVectorType getAverageProducts(const std::vector<FockState>& Masks) const;
+    /** Returns the contributions of the part to the averages \f$ \langle A^+_p A_q \rangle \f$ of the pairs of several operators, 
+     * e.g. products of the annihilation operators. Every operator is applied to the eigenvectors in the FockState basis, 
+     * weighted by the square roots of the weights. The averages of the operators, which map the part to the same block, 
+     * are a single product of the matrices of the weighted images. The eigenstates are taken in panels to bound the memory.
+     * \param[in] Operators The operators \f$ A_p \f$, each of them maps the part to a single block. */
+    MatrixType getOverlapAverages(const std::vector<Operator>& Operators) const;
 
     /** Returns the partition function of this part. */
     RealType getPartialZ(void) const;
 
-    /** Truncates this part if it does not include any states having larger weight than Tolerance. */
+    /** Truncates the states having weights not larger than Tolerance. 
+     * The part is truncated if it does not include any states having larger weight than Tolerance. */
     void truncate(RealType Tolerance);
 
     /** Returns true if this part has not been truncated. */
     bool isRetained() const;
+    /** Returns true if the state has not been truncated. */
+    bool isRetained(InnerQuantumState s) const;
+    /** Returns the states, which have not been truncated, in ascending order. 
+     * The Lehmann sums iterate over them, see GreensFunctionPart::computeTransitions and TwoParticleGFPart::compute. */
+    const std::vector<InnerQuantumState>& getRetainedStates() const;
 };
 
 } // end of namespace Pomerol
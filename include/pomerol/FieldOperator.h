@@ -1,5 +1,5 @@
 /** \file include/pomerol/FieldOperator.h
-** \brief Declaration of field operators : creation and annihilation operators.
+** \brief Declaration of field operators : creation and annihilation operators, and of quadratic operators.
 ** 
 ** \author Igor Krivenko (Igor.S.Krivenko@gmail.com)
 ** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
@@ -8,6 +8,7 @@
 #ifndef __INCLUDE_FIELDOPERATOR_H
 #define __INCLUDE_FIELDOPERATOR_H
 
+#include<set>
 #include<boost/bimap.hpp>
 
 #include"Misc.h"
@@ -22,6 +23,12 @@ namespace Pomerol{
  */
 typedef std::pair<BlockNumber,BlockNumber> BlockMapping;
 
+/** \typedef
+ * A set of left and right indices of the parts of creation operators. The part of an annihilation operator,
+ * which is the adjoint of a creation operator part, is given by the same pair.
+ */
+typedef std::set<BlockMapping> BlockMappingSet;
+
 /** This class is a parent class for creation/annihilation operators which act
  * on all blocks of quantum states */ 
 class FieldOperator : public ComputableObject 
@@ -41,8 +48,8 @@ protected:
     const StatesClassification &S;
     /** A reference to a Hamiltonian object */
     const Hamiltonian &H;
-    /** A reference an Operator object (OperatorPresets::C or Cdag). */
-    const Operator *O;
+    /** A pointer to an Operator object (OperatorPresets::C, Cdag or any Operator of a QuadraticOperator). */
+    boost::shared_ptr<const Operator> O;
 
     /** An index of the operator */
     ParticleIndex Index;
@@ -67,6 +74,9 @@ protected:
      */
     virtual QuantumNumbers mapsTo(const QuantumNumbers& in) const;
 
+    /** Return the order of computation of the parts, in which the eigenvectors of every block are used in consecutive parts. */
+    std::vector<size_t> getComputeOrder() const;
+
 public:
     /** Constructor
      * \param[in] IndexInfo A reference to an IndexClassification object
@@ -100,6 +110,17 @@ public:
     virtual void prepare(void) = 0;
     /** Computes all world-lines */
     void compute(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Compute a set of parts, possibly of different operators, at once. 
+     * The parts are divided between the ranks of comm by their cost and the parts of each rank are computed by the OpenMP threads.
+     * The matrix elements are broadcast to all ranks afterwards.
+     * \param[in] Parts The parts in the order of computation, see getComputeOrder(). */
+    static void computeParts(const std::vector<FieldOperatorPart*>& Parts, const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Recomputes all world-lines after the Hamiltonian has been updated. The parts and the block mapping are kept. */
+    void update(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Returns the largest error of the stored matrix elements of all parts, see FieldOperatorPart::getStorageError. */
+    RealType getStorageError(void) const;
+    /** Returns the number of bytes occupied by the matrix elements of all parts, see FieldOperatorPart::getMemoryUsage. */
+    size_t getMemoryUsage(void) const;
 };
 
 /** A creation operator in the eigenspace of a Hamiltonian */
@@ -112,8 +133,6 @@ class CreationOperator : public FieldOperator
     friend class AnnihilationOperator;
     friend class FieldOperatorContainer;
 public:
-    /* Returns hermitian conjugate of current operator */
-    AnnihilationOperator& transpose(void);
     void prepare();
 
     /** Constructor
@@ -130,9 +149,6 @@ class AnnihilationOperator : public FieldOperator
     friend class CreationOperator;
     friend class FieldOperatorContainer;
 public:
-    /* Returns hermitian conjugate of current operator */
-    CreationOperator& transpose(void);
-
     void prepare();
 
     /** Constructor
@@ -144,5 +160,31 @@ public:
     AnnihilationOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, ParticleIndex Index);
 };
 
+/** An operator, which maps each block of quantum states to a single block, in the eigenspace of a Hamiltonian.
+ * The bilinear operators c^+_i c_j, e.g. the densities and the spin flips, are constructed from their indices.
+ * Other operators of this kind, e.g. the pair operators c_i c_j or the sums of bilinear operators, are given as an Operator.
+ * Two such operators define a Susceptibility. */
+class QuadraticOperator : public FieldOperator
+{
+public:
+    void prepare();
+
+    /** Constructor of the operator c^+_i c_j.
+     * \param[in] IndexInfo A reference to an IndexClassification object
+     * \param[in] S A reference to a StatesClassification object
+     * \param[in] H A reference to a Hamiltonian object
+     * \param[in] Index1 The index i of the creation operator
+     * \param[in] Index2 The index j of the annihilation operator
+     */
+    QuadraticOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, ParticleIndex Index1, ParticleIndex Index2);
+    /** Constructor
+     * \param[in] IndexInfo A reference to an IndexClassification object
+     * \param[in] S A reference to a StatesClassification object
+     * \param[in] H A reference to a Hamiltonian object
+     * \param[in] O An operator. Its monomials are copied. getIndex() returns 0 for such an operator.
+     */
+    QuadraticOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, const Operator &O);
+};
+
 } // end of namespace Pomerol
 #endif // endif :: #ifdef __INCLUDE_FIELDOPERATOR_H
@@ -12,12 +12,15 @@
 #include"FieldOperator.h"
 #include"Hamiltonian.h"
 #include"StatesClassification.h"
+#include"DensityMatrix.h"
 
 namespace Pomerol{
 
 /** This class represents a container to store and retrieve FieldOperators ( CreationOperator or AnnihilationOperator 
  * rotated to eigenvector basis of Hamiltonian H ) for a given Index.
- * If no field operator is yet initialized then calculation of the field operator is done.
+ * The operators are either prepared and computed all at once by prepareAll() and computeAll(), or on demand :
+ * an operator is prepared on its first access and computed by acquire(). The computed operators, which are not in use, 
+ * are evicted when they exceed the memory budget, so only the working set of the operators is kept.
  */
 class FieldOperatorContainer 
 {
@@ -35,6 +38,29 @@ private:
     mutable std::map <ParticleIndex, CreationOperator*> mapCreationOperators;
     /** A map which gives a link to the AnnihilationOperator for a given index */
     mutable std::map <ParticleIndex, AnnihilationOperator*> mapAnnihilationOperators;
+    /** If false, only the parts of the creation operators in NeededParts are computed. */
+    bool AllParts;
+    /** The left and right blocks of the creation operator parts, which are computed if AllParts is false. */
+    BlockMappingSet NeededParts;
+    /** Computes the parts of the creation operators of given indices, which are not computed yet and are needed, 
+     * and sets the parts of the annihilation operators to their adjoints. */
+    void computeParts(const std::set<ParticleIndex>& Indices, const boost::mpi::communicator& comm) const;
+
+    /** The largest number of bytes of the computed operators, see setMemoryBudget. 0 if there is no limit. */
+    size_t MemoryBudget;
+    /** The number of current uses of the operators of each index, see acquire. */
+    mutable std::map<ParticleIndex, int> Uses;
+    /** The number of announced uses of the operators of each index, see hint. */
+    mutable std::map<ParticleIndex, int> ExpectedUses;
+    /** The time of the last acquire of the operators of each index. */
+    mutable std::map<ParticleIndex, size_t> LastUse;
+    /** The number of the calls of acquire. */
+    mutable size_t Clock;
+    /** Creates and prepares the operators of an index, unless they exist. */
+    void prepareIndex(ParticleIndex in) const;
+    /** Releases the elements of the computed operators, which are not in use, until all operators fit into MemoryBudget.
+     * The operators with no announced uses go first, then the least recently used ones. */
+    void evict() const;
 public:
     /** Constructor.
      * \param[in] S A reference to a states classification object.
@@ -45,11 +71,44 @@ public:
         const Hamiltonian &H, bool use_transpose = false);
 
     void prepareAll(std::set<ParticleIndex> in = std::set<ParticleIndex>());
-    void computeAll();
+    /** Computes all creation operators together, see FieldOperator::computeParts. The annihilation operators are their adjoints. */
+    void computeAll(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Computes only the parts of the creation operators with the left and right blocks in Needed and their adjoints, 
+     * the other parts are left uncomputed. The set is found in the prepare phase of the Green's functions,
+     * see GreensFunction::getNeededParts and TwoParticleGF::getNeededParts, or from the density matrix, see getRetainedParts.
+     * \param[in] Needed The pairs of the left and right blocks of the needed parts. */
+    void computeAll(const BlockMappingSet& Needed, const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Recomputes all operators after the Hamiltonian has been updated. The operators, their block mappings
+     * and the set of the needed parts are kept. */
+    void updateAll(const boost::mpi::communicator& comm = boost::mpi::communicator());
+
+    /** Returns the parts of the prepared creation operators, which map a retained block of DM or to a retained block. 
+     * These are all the parts used by the Green's functions. A TwoParticleGF may use the parts between two truncated blocks. */
+    BlockMappingSet getRetainedParts(const DensityMatrix& DM) const;
+    /** Returns the blocks, which are connected by none of the parts in Needed. 
+     * Their eigenvectors are not used by computeAll(Needed) and may be released by Hamiltonian::releaseEigenvectors. */
+    std::set<BlockNumber> getUnusedBlocks(const BlockMappingSet& Needed) const;
+
+    /** Sets the memory budget of the computed operators. The operators, which are not in use, are evicted 
+     * to keep the matrix elements of all operators within the budget. The evicted operators are prepared and are computed again by acquire.
+     * \param[in] Bytes The number of bytes, 0 for no limit (default). */
+    void setMemoryBudget(size_t Bytes);
+    /** Returns the number of bytes occupied by the matrix elements of all operators. */
+    size_t getMemoryUsage() const;
+    /** Starts a use of the operators of given indices : computes them, if they are not computed, and keeps them from eviction until release. 
+     * Other operators may be evicted to make room for them.
+     * \param[in] Indices The indices of the operators.
+     * \param[in] comm The ranks, which compute the operators. All of them have to acquire the same indices in the same order. */
+    void acquire(const std::set<ParticleIndex>& Indices, const boost::mpi::communicator& comm = boost::mpi::communicator()) const;
+    /** Ends a use of the operators of given indices, which has been started by acquire. The operators with no uses may be evicted. */
+    void release(const std::set<ParticleIndex>& Indices) const;
+    /** Announces a future use of the operators of given indices, e.g. by the GF containers in prepareAll. 
+     * The operators, which will be used, are evicted after all others. A release consumes an announced use. */
+    void hint(const std::set<ParticleIndex>& Indices) const;
 
-    /** Returns the CreationOperator for a given Index. Makes on-demand computation. */
+    /** Returns the CreationOperator for a given Index. Prepares it on demand, it is computed by acquire or computeAll. */
     const CreationOperator& getCreationOperator(ParticleIndex in) const;
-    /** Returns the AnnihilationOperator for a given Index. Makes on-demand computation */
+    /** Returns the AnnihilationOperator for a given Index. Prepares it on demand, it is computed by acquire or computeAll. */
     const AnnihilationOperator& getAnnihilationOperator(ParticleIndex in) const;
 };
 
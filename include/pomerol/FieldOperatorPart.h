@@ -13,8 +13,138 @@
 #include "HamiltonianPart.h"
 #include "OperatorPresets.h"
 
+#include <algorithm>
+
 namespace Pomerol{
 
+/** A lightweight view of the matrix elements of a FieldOperatorPart in a given storage order.
+ * The view does not own the elements, it reads the arrays of a stored sparse matrix or of a stored dense matrix.
+ * The compressed arrays of a matrix A in one storage order are the ones of A^+ in the other storage order up to
+ * a complex conjugation, so an adjoint view conjugates the values on access and swaps the dimensions.
+ * A dense matrix is read with the strides of the required order.
+ * The view is valid as long as the viewed matrix is not modified.
+ */
+template <int StorageOrder>
+class FieldOperatorView {
+public:
+    typedef Eigen::SparseMatrix<StorageMelemType,StorageOrder> StoredMatrixType;
+    typedef long Index;
+    static const bool IsRowMajor = (StorageOrder == Eigen::RowMajor);
+private:
+    Index Rows, Cols;
+    /** The compressed arrays of the sparse matrix. Null for a dense matrix. */
+    const int *OuterIndex, *InnerIndex;
+    /** The nonzero values of the sparse matrix or all values of the dense matrix. */
+    const StorageMelemType *Values;
+    /** True if a dense matrix is viewed. */
+    bool Dense;
+    /** The element (outer, inner) of a dense matrix is Values[outer*OuterStride + inner*InnerStride]. */
+    Index OuterStride, InnerStride;
+    /** True if the values are conjugated on access. */
+    bool Conjugate;
+
+    static StorageMelemType conjugate(const StorageMelemType& x, bool Conjugate)
+    {
+        #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+        return (Conjugate ? std::conj(x) : x);
+        #else
+        return x;
+        #endif
+    }
+    StorageMelemType denseValue(Index Outer, Index Inner) const { return Values[Outer*OuterStride + Inner*InnerStride]; };
+public:
+    /** Constructor.
+     * \param[in] M A compressed sparse matrix. It is in the order of the view, or in the other order if Adjoint is true.
+     * \param[in] Adjoint If true, the view is the adjoint of M.
+     */
+    template <int Order>
+    FieldOperatorView(const Eigen::SparseMatrix<StorageMelemType,Order>& M, bool Adjoint = false):
+        Rows(Adjoint ? M.cols() : M.rows()), Cols(Adjoint ? M.rows() : M.cols()),
+        OuterIndex(M.outerIndexPtr()), InnerIndex(M.innerIndexPtr()), Values(M.valuePtr()), 
+        Dense(false), OuterStride(0), InnerStride(0), Conjugate(Adjoint)
+    {
+        assert(M.isCompressed() && ((Order == StorageOrder) != Adjoint));
+    }
+    /** Constructor.
+     * \param[in] M A dense matrix.
+     * \param[in] Adjoint If true, the view is the adjoint of M.
+     */
+    FieldOperatorView(const StorageColMajorDenseMatrixType& M, bool Adjoint = false):
+        Rows(Adjoint ? M.cols() : M.rows()), Cols(Adjoint ? M.rows() : M.cols()),
+        OuterIndex(NULL), InnerIndex(NULL), Values(M.data()), Dense(true), Conjugate(Adjoint)
+    {
+        // The columns of M are contiguous, they are the columns of the view or the rows of the adjoint view.
+        bool Contiguous = (IsRowMajor == Adjoint);
+        OuterStride = (Contiguous ? M.rows() : 1);
+        InnerStride = (Contiguous ? 1 : M.rows());
+    }
+
+    /** An iterator over the nonzero elements of a single row (column) of a row-major (column-major) view. 
+     * The zeros of a dense matrix are skipped. */
+    class InnerIterator {
+        const FieldOperatorView& View;
+        Index Outer, Position, End;
+        void skipZeros() { if (View.Dense) for (; Position < End && View.denseValue(Outer,Position) == StorageMelemType(0); ++Position); };
+    public:
+        InnerIterator(const FieldOperatorView& View, Index Outer):View(View), Outer(Outer),
+            Position(View.Dense ? 0 : View.OuterIndex[Outer]), End(View.Dense ? View.innerSize() : View.OuterIndex[Outer+1]) { skipZeros(); };
+        InnerIterator& operator++() { ++Position; skipZeros(); return *this; };
+        operator bool() const { return Position < End; };
+        Index index() const { return (View.Dense ? Position : View.InnerIndex[Position]); };
+        Index row() const { return (IsRowMajor ? Outer : index()); };
+        Index col() const { return (IsRowMajor ? index() : Outer); };
+        StorageMelemType value() const { return conjugate(View.Dense ? View.denseValue(Outer,Position) : View.Values[Position], View.Conjugate); };
+    };
+
+    Index rows() const { return Rows; };
+    Index cols() const { return Cols; };
+    Index outerSize() const { return (IsRowMajor ? Rows : Cols); };
+    Index innerSize() const { return (IsRowMajor ? Cols : Rows); };
+    /** Returns the number of stored elements. All elements of a dense matrix are stored. */
+    Index nonZeros() const { return (Dense ? Rows*Cols : OuterIndex[outerSize()]); };
+    /** Returns true if a dense matrix is viewed. */
+    bool isDense() const { return Dense; };
+    /** Returns a single matrix element. A binary search in the row (column) of a row-major (column-major) sparse view. */
+    StorageMelemType coeff(Index row, Index col) const 
+    {
+        Index Outer = (IsRowMajor ? row : col), Inner = (IsRowMajor ? col : row);
+        if (Dense) return conjugate(denseValue(Outer,Inner), Conjugate);
+        const int *Begin = InnerIndex + OuterIndex[Outer], *End = InnerIndex + OuterIndex[Outer+1];
+        const int *Found = std::lower_bound(Begin, End, int(Inner));
+        return ((Found != End && *Found == Inner) ? conjugate(Values[Found - InnerIndex], Conjugate) : StorageMelemType(0));
+    };
+    /** Returns a sparse copy of the viewed elements. */
+    StoredMatrixType eval() const
+    {
+        std::vector<Eigen::Triplet<StorageMelemType> > Triplets;
+        for (Index Outer=0; Outer<outerSize(); ++Outer)
+            for (InnerIterator it(*this,Outer); it; ++it) Triplets.push_back(Eigen::Triplet<StorageMelemType>(it.row(), it.col(), it.value()));
+        StoredMatrixType M(Rows, Cols);
+        M.setFromTriplets(Triplets.begin(), Triplets.end());
+        return M;
+    };
+    /** Returns a dense copy of the viewed elements in MelemType. */
+    ColMajorDenseMatrixType dense() const
+    {
+        ColMajorDenseMatrixType M;
+        if (Dense) {
+            Eigen::Map<const StorageColMajorDenseMatrixType> Stored(Values, Conjugate ? Cols : Rows, Conjugate ? Rows : Cols);
+            if (Conjugate) M = Stored.adjoint().template cast<MelemType>(); 
+            else M = Stored.template cast<MelemType>();
+            }
+        else {
+            M.setZero(Rows, Cols);
+            for (Index Outer=0; Outer<outerSize(); ++Outer)
+                for (InnerIterator it(*this,Outer); it; ++it) M(it.row(), it.col()) = MelemType(it.value());
+            };
+        return M;
+    };
+    friend std::ostream& operator<<(std::ostream& out, const FieldOperatorView& View) { return out << View.eval(); };
+};
+
+typedef FieldOperatorView<Eigen::RowMajor> RowMajorView;
+typedef FieldOperatorView<Eigen::ColMajor> ColMajorView;
+
 /** This class is an abstract implementation of the electronic creation/annihilation operators, which acts in the eigenbasis of the Hamiltonian
  * between it's certain blocks.
  * Rotation to the basis is done in the following way:
@@ -35,8 +165,8 @@ public:
     /** A reference to the HamiltonianPart on the left hand side. */
     const HamiltonianPart &HTo;
 protected:
-    /** A pointer to the Operator object ( Pomerol::OperatorPresets::C or Cdag ). */
-    Operator *O;
+    /** A pointer to the Operator object ( Pomerol::OperatorPresets::C, Cdag or any Operator of a QuadraticOperatorPart ). */
+    boost::shared_ptr<const Operator> O;
 
     /** Index of the field operator. */
     ParticleIndex PIndex;
@@ -44,6 +174,17 @@ protected:
     RowMajorMatrixType elementsRowMajor;
     /** Copy of the Storage of the matrix elements of the operator. Column ordered sparse matrix. */
     ColMajorMatrixType elementsColMajor;
+    /** Storage of the matrix elements of a nearly dense operator. If used, the sparse matrices are empty. */
+    StorageColMajorDenseMatrixType elementsDense;
+    /** True if the matrix elements are stored in elementsDense. */
+    bool DenseStorage;
+    /** The part, which is the adjoint of this one. If set, the elements are not stored in this part, 
+     * but viewed in the storage of AdjointOf. Null if the part stores its elements. */
+    const FieldOperatorPart *AdjointOf;
+    /** Drop the stored elements and view the ones of a computed part as the adjoint. Changes the Status of the object to Computed. */
+    void setAdjointOf(const FieldOperatorPart &Part);
+    /** The largest deviation of the stored matrix elements from the ones calculated in MelemType. Nonzero with POMEROL_FLOAT_STORAGE. */
+    RealType StorageError;
     /** The tolerance with which the matrix elements are evaluated. */
     //static
     const RealType MatrixElementTolerance; //1e-8 by default
@@ -51,6 +192,9 @@ protected:
     virtual void do_nothing(void) = 0;
 
 public:
+    /** The parts with a larger fraction of nonzero matrix elements are stored as dense matrices. 
+     * 0.5 by default. Affects the parts computed afterwards. */
+    static RealType DenseFillRatio;
 
     /** Constructor.
      * \param[in] IndexInfo A const reference to the IndexClassification object.
@@ -66,10 +210,21 @@ public:
     /** Print all matrix elements of the operator to screen. */
     void print_to_screen() const;
 
-    /** Returns the row ordered sparse matrix of matrix elements. */
-    const RowMajorMatrixType& getRowMajorValue(void) const;
-    /** Returns the column ordered sparse matrix of matrix elements. */
-    const ColMajorMatrixType& getColMajorValue(void) const;
+    /** Releases the matrix elements, the part returns to the Prepared status and can be computed again. */
+    void releaseElements(void);
+    /** Returns the number of bytes occupied by the matrix elements. An adjoint view occupies none. */
+    size_t getMemoryUsage(void) const;
+
+    /** Returns a row ordered view of the matrix elements. Throws if the part is not computed. */
+    RowMajorView getRowMajorValue(void) const;
+    /** Returns a column ordered view of the matrix elements. Throws if the part is not computed. */
+    ColMajorView getColMajorValue(void) const;
+    /** Returns true if the matrix elements are stored as a dense matrix. */
+    bool isDense(void) const;
+    /** Returns true if the part views the elements of its adjoint instead of storing them. */
+    bool isAdjointView(void) const;
+    /** Returns the largest error of the stored matrix elements with respect to the ones calculated in double precision. */
+    RealType getStorageError(void) const;
     /** Returns the right hand side index. */
     BlockNumber getRightIndex(void) const;
     /** Returns the left hand side index. */
@@ -98,8 +253,9 @@ class AnnihilationOperatorPart : public FieldOperatorPart
 public :
     /** Constructor. Look FieldOperatorPart::FieldOperatorPart. */
     AnnihilationOperatorPart(const IndexClassification &IndexInfo, const StatesClassification &S, const HamiltonianPart &HFrom, const HamiltonianPart &HTo, ParticleIndex PIndex);
-    /** Construct the CreationOperatorPart from the class (transpose it). */
-    const CreationOperatorPart& transpose(void) const;
+    /** Construct the CreationOperatorPart, which is the hermitian conjugate of the class. 
+     * The result views the elements of the class, so it is valid as long as the class is. */
+    CreationOperatorPart transpose(void) const;
 };
 
 /** This class is inheried from FieldOperatorPart and is a part of electronic creation operator in the eigenbasis of the Hamiltonian between it's two blocks. */
@@ -113,8 +269,23 @@ class CreationOperatorPart : public FieldOperatorPart
 public :
     /** Constructor. Look FieldOperatorPart::FieldOperatorPart. */
     CreationOperatorPart(const IndexClassification &IndexInfo, const StatesClassification &S, const HamiltonianPart &HFrom, const HamiltonianPart &HTo, ParticleIndex PIndex);
-    /** Construct the AnnihilationOperatorPart from the class (transpose it). */
-    const AnnihilationOperatorPart& transpose(void) const;
+    /** Construct the AnnihilationOperatorPart, which is the hermitian conjugate of the class. 
+     * The result views the elements of the class, so it is valid as long as the class is. */
+    AnnihilationOperatorPart transpose(void) const;
+};
+
+/** This class is inherited from FieldOperatorPart and is a part of a bosonic operator, e.g. c^+_i c_j, in the eigenbasis 
+ * of the Hamiltonian between it's two blocks. Any Operator, which maps the states of HFrom to the states of HTo, can be used. */
+class QuadraticOperatorPart : public FieldOperatorPart
+{
+    /** Does nothing. Private. */
+    void do_nothing(){};
+public :
+    /** Constructor. Look FieldOperatorPart::FieldOperatorPart.
+     * \param[in] O The operator. It is shared by all parts of a QuadraticOperator.
+     */
+    QuadraticOperatorPart(const IndexClassification &IndexInfo, const StatesClassification &S, const HamiltonianPart &HFrom, const HamiltonianPart &HTo, 
+                          boost::shared_ptr<const Operator> O);
 };
 
 } // end of namespace Pomerol
@@ -0,0 +1,80 @@
+/** \file include/pomerol/FrequencyGrid.h
+** \brief Grids of complex frequencies for the evaluation of the Green's functions.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+#ifndef __INCLUDE_FREQUENCYGRID_H
+#define __INCLUDE_FREQUENCYGRID_H
+
+#include "Misc.h"
+
+namespace Pomerol{
+
+/** A list of complex frequencies, at which the Green's functions are evaluated at once, see GFContainer::evaluate.
+ * The points, which have their complex conjugates in the same grid, are paired. The values at the conjugate points
+ * follow from the symmetry \f$ G_{ij}(z^*) = G_{ji}(z)^* \f$, so only one point of each pair is evaluated.
+ */
+class FrequencyGrid {
+    /** The frequencies. */
+    ComplexVectorType Points;
+    /** The position of the complex conjugate of every point in the grid, or -1 if it is not in the grid. */
+    std::vector<long> Conjugates;
+
+protected:
+    /** Constructor of an empty grid. The points are set by the derived grids with setPoints. */
+    FrequencyGrid();
+    /** Sets the points and pairs the points with their complex conjugates. */
+    void setPoints(const ComplexVectorType& Points);
+
+public:
+    /** Constructor of a grid of arbitrary points.
+     * \param[in] Points The frequencies.
+     */
+    FrequencyGrid(const ComplexVectorType& Points);
+
+    /** Returns the number of points. */
+    long size() const;
+    /** Returns the frequencies. */
+    const ComplexVectorType& getPoints() const;
+    /** Returns the n-th frequency. */
+    ComplexType getPoint(long n) const;
+    /** Returns the position of the complex conjugate of the n-th point, or -1 if it is not in the grid. */
+    long getConjugate(long n) const;
+};
+
+/** A range of fermionic Matsubara frequencies \f$ i\omega_n = i\pi(2n+1)/\beta \f$, \f$ MinNumber \leq n < MaxNumber \f$. */
+class FermionicMatsubaraGrid : public FrequencyGrid {
+public:
+    /** Constructor.
+     * \param[in] beta The inverse temperature.
+     * \param[in] MinNumber The number of the first frequency.
+     * \param[in] MaxNumber The number next to the one of the last frequency.
+     */
+    FermionicMatsubaraGrid(RealType beta, long MinNumber, long MaxNumber);
+};
+
+/** A range of bosonic Matsubara frequencies \f$ i\Omega_n = 2i\pi n/\beta \f$, \f$ MinNumber \leq n < MaxNumber \f$. */
+class BosonicMatsubaraGrid : public FrequencyGrid {
+public:
+    /** Constructor.
+     * \param[in] beta The inverse temperature.
+     * \param[in] MinNumber The number of the first frequency.
+     * \param[in] MaxNumber The number next to the one of the last frequency.
+     */
+    BosonicMatsubaraGrid(RealType beta, long MinNumber, long MaxNumber);
+};
+
+/** A uniform grid of real frequencies shifted above the real axis, \f$ \omega_k + i\eta \f$. */
+class RealFrequencyGrid : public FrequencyGrid {
+public:
+    /** Constructor.
+     * \param[in] Min The first real frequency.
+     * \param[in] Max The last real frequency.
+     * \param[in] NumberOfPoints The number of points, including both ends.
+     * \param[in] Broadening The distance \f$ \eta \f$ from the real axis.
+     */
+    RealFrequencyGrid(RealType Min, RealType Max, long NumberOfPoints, RealType Broadening);
+};
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_FREQUENCYGRID_H
@@ -13,6 +13,7 @@
 #include"GreensFunction.h"
 #include"FieldOperatorContainer.h"
 #include"IndexContainer2.h"
+#include"FrequencyGrid.h"
 
 namespace Pomerol{
 
@@ -25,10 +26,28 @@ public:
     GFContainer(const IndexClassification& IndexInfo,
                 const StatesClassification &S,
                 const Hamiltonian &H, const DensityMatrix &DM, const FieldOperatorContainer& Operators);
+    /** Constructs the Green's functions of G at the temperature of another density matrix, see GreensFunction::GreensFunction.
+     * computeAll() only weights the transitions of the computed Green's functions of G. */
+    GFContainer(const GFContainer& G, const DensityMatrix &DM);
 
 
     void prepareAll(const std::set<IndexCombination2>& InitialIndices = std::set<IndexCombination2>());
-    void computeAll();
+    /** Computes all Green's functions, which are not computed yet. The parts of a Green's function are computed in parallel,
+     * see GreensFunction::computeParts, while its operators are acquired. The parts of all Green's functions,
+     * which know their transitions on all ranks, are computed together and need no operators.
+     * \param[in] comm The ranks, which share the parts. All of them have to call computeAll. */
+    void computeAll(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Recomputes all Green's functions after the Hamiltonian, the density matrix and the field operators have been updated. */
+    void updateAll(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Returns the parts of the creation operators, which are used by all prepared Green's functions, see FieldOperatorContainer::computeAll. */
+    BlockMappingSet getNeededParts() const;
+    /** Returns the values of several computed Green's functions on a grid of frequencies, the element (c,n) is the value of
+     * the c-th component at the n-th point. The components are evaluated in parallel at blocks of points, see TermArrays.
+     * If the transposed component is also requested, the values at the conjugate points of the grid are obtained
+     * from \f$ G_{ij}(z^*) = G_{ji}(z)^* \f$.
+     * \param[in] Grid The frequencies.
+     * \param[in] Indices The components. */
+    ComplexMatrixType evaluate(const FrequencyGrid& Grid, const std::vector<IndexCombination2>& Indices);
 
 protected:
 
@@ -16,6 +16,7 @@
 #include"FieldOperator.h"
 #include"DensityMatrix.h"
 #include"GreensFunctionPart.h"
+#include"TermArrays.h"
 
 namespace Pomerol{
 
@@ -30,9 +31,13 @@ namespace Pomerol{
  * It is actually a container class for a collection of parts (most of real calculations
  * take place inside the parts). A pair of parts, one part of an annihilation operator and
  * another from a creation operator, corresponds to a part of the Green's function.
+ * Once the parts are computed, their terms are merged into a single TermArrays object,
+ * which is used to evaluate the Green's function at given frequencies.
  */
 class GreensFunction : public Thermal, public ComputableObject {
 
+    friend class GFContainer;
+
     /** A reference to a states classification object. */
     const StatesClassification& S;
     /** A reference to a Hamiltonian. */
@@ -52,6 +57,14 @@ class GreensFunction : public Thermal, public ComputableObject {
      */
     std::list<GreensFunctionPart*> parts;
 
+    /** The left and right blocks of the creation operator parts, which are used by the parts. */
+    BlockMappingSet NeededParts;
+
+    /** The terms of all parts, the similar ones are merged. */
+    TermArrays Terms;
+    /** Collects the terms of the computed parts into Terms. */
+    void freeze();
+
 public:
      /** Constructor.
      * \param[in] S A reference to a states classification object.
@@ -66,15 +79,31 @@ public:
      * \param[in] GF GreensFunction object to be copied.
      */
     GreensFunction(const GreensFunction& GF);
+    /** Constructs the Green's function at the temperature of another density matrix. The parts share the transitions
+     * with the parts of GF, which do not depend on the temperature, so compute() only weights them, see GreensFunctionPart::compute.
+     * The density matrix should not retain the states, which are truncated by the density matrix of GF.
+     * \param[in] GF A prepared Green's function.
+     * \param[in] DM A reference to a computed density matrix.
+     */
+    GreensFunction(const GreensFunction& GF, const DensityMatrix& DM);
     /** Destructor. */
     ~GreensFunction();
 
     /** Chooses relevant parts of C and CX and allocates resources for the parts of the Green's function. */
     void prepare(void);
-    /** Actually computes the parts and fills the internal cache of precomputed values.
-     * \param[in] NumberOfMatsubaras Number of positive Matsubara frequencies.
+    /** Actually computes the parts, see computeParts.
+     * \param[in] comm The ranks, which share the parts. All of them have to compute the Green's function.
      */
-    void compute();
+    void compute(const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Computes the parts of one or several Green's functions together. The parts are distributed over the ranks by their sizes
+     * and are computed by the threads of each rank in parallel. The owner of a part broadcasts its terms to the other ranks.
+     * The parts, which know their transitions, only weight them, see GreensFunctionPart::compute.
+     * \param[in] Parts The parts to compute.
+     * \param[in] comm The ranks, which share the parts. All of them have to call computeParts with the same parts.
+     */
+    static void computeParts(const std::vector<GreensFunctionPart*>& Parts, const boost::mpi::communicator& comm = boost::mpi::communicator());
+    /** Recomputes the parts after the Hamiltonian, the density matrix and the field operators have been updated. The parts are kept. */
+    void update(const boost::mpi::communicator& comm = boost::mpi::communicator());
 
     /** Returns the 'bit' (index) of the operator C or CX.
      * \param[in] Position Use C for Position==0 and CX for Position==1.
@@ -91,12 +120,23 @@ public:
      */
     ComplexType operator()(ComplexType z) const;
 
+     /** Returns the values of the Green's function calculated at a vector of frequencies, see TermArrays.
+     * \param[in] z Input frequencies
+     */
+    ComplexVectorType operator()(const ComplexVectorType& z) const;
+
      /** Returns the value of the Green's function calculated at a given imaginary time point.
      * \param[in] tau Imaginary time point.
      */
     ComplexType of_tau(RealType tau) const;
 
     bool isVanishing(void) const;
+    /** Returns true if all parts know their transitions, so compute() does not need the field operators. */
+    bool hasTransitions(void) const;
+
+    /** Returns the left and right blocks of the parts of the creation operators, which are used by the Green's function,
+     * see FieldOperatorContainer::computeAll. Available after prepare(), the operators have to be prepared only. */
+    const BlockMappingSet& getNeededParts(void) const;
 };
 
 inline ComplexType GreensFunction::operator()(long int MatsubaraNumber) const {
@@ -104,12 +144,12 @@ inline ComplexType GreensFunction::operator()(long int MatsubaraNumber) const {
 
 inline ComplexType GreensFunction::operator()(ComplexType z) const {
     if(Vanishing) return 0;
-    else {
-        ComplexType Value = 0;
-        for(std::list<GreensFunctionPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
-            Value += (**iter)(z);
-        return Value;
-    };
+    else return Terms(z);
+}
+
+inline ComplexVectorType GreensFunction::operator()(const ComplexVectorType& z) const {
+    if(Vanishing) return ComplexVectorType::Zero(z.size());
+    else return Terms(z);
 }
 
 inline ComplexType GreensFunction::of_tau(RealType tau) const {
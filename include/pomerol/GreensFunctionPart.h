@@ -9,12 +9,15 @@
 
 #include<iomanip>
 #include<cmath>
+#include<vector>
+#include<boost/shared_ptr.hpp>
 
 #include"Misc.h"
 #include"StatesClassification.h"
 #include"HamiltonianPart.h"
 #include"FieldOperator.h"
 #include"DensityMatrixPart.h"
+#include"DensityMatrix.h"
 #include"TermList.h"
 
 namespace Pomerol{
@@ -25,6 +28,8 @@ namespace Pomerol{
  */
 class GreensFunctionPart : public Thermal
 {
+    friend class GreensFunction;
+
     /** A reference to a part of a Hamiltonian (inner index iterates through it). */
     const HamiltonianPart& HpartInner;
     /** A reference to a part of a Hamiltonian (outer index iterates through it). */
@@ -99,6 +104,28 @@ class GreensFunctionPart : public Thermal
     /** A list of all terms. */
     TermList<Term> Terms;
 
+    /** A transition between an outer and an inner eigenstate, it does not depend on the temperature. */
+    struct Transition {
+        /** The outer eigenstate. */
+        InnerQuantumState Outer;
+        /** The inner eigenstate. */
+        InnerQuantumState Inner;
+        /** The product of the matrix elements \f$ \langle outer|C|inner\rangle\langle inner|C^+|outer\rangle \f$. */
+        MelemType MatrixElement;
+        /** The difference of the energies \f$ E_{inner} - E_{outer} \f$. */
+        RealType Pole;
+
+        Transition(InnerQuantumState Outer, InnerQuantumState Inner, MelemType MatrixElement, RealType Pole) :
+            Outer(Outer), Inner(Inner), MatrixElement(MatrixElement), Pole(Pole) {}
+    };
+    /** The transitions of the part. They are shared with the parts of the Green's function at other temperatures. */
+    boost::shared_ptr<std::vector<Transition> > Transitions;
+
+    /** Fills the list of terms from the transitions and the weights of the density matrix. */
+    void computeTerms(void);
+    /** Stores a transition, unless its matrix element is negligible. */
+    void addTransition(InnerQuantumState Outer, InnerQuantumState Inner, MelemType MatrixElement);
+
     /** A matrix element with magnitude less than this value is treated as zero. */
     const RealType MatrixElementTolerance; // 1e-8;
 
@@ -115,9 +142,20 @@ public:
     GreensFunctionPart(const AnnihilationOperatorPart& C, const CreationOperatorPart& CX,
                        const HamiltonianPart& HpartInner, const HamiltonianPart& HpartOuter,
                        const DensityMatrixPart& DMpartInner, const DensityMatrixPart& DMpartOuter);
+    /** Constructs the part at the temperature of another density matrix. The transitions are shared with Part.
+     * \param[in] Part A part of the Green's function at another temperature.
+     * \param[in] DM A reference to a density matrix.
+     */
+    GreensFunctionPart(const GreensFunctionPart& Part, const DensityMatrix& DM);
 
-    /** Iterates over all matrix elements and fills the list of terms. */
+    /** Iterates over the matrix elements and stores the transitions with non-vanishing matrix elements. 
+     * Only the transitions with at least one state retained by the density matrix are stored: 
+     * the outer states, which are truncated, are combined with the retained inner states only, see DensityMatrixPart::getRetainedStates. */
+    void computeTransitions(void);
+    /** Fills the list of terms. The transitions are found first, unless they are known already. */
     void compute(void);
+    /** Returns true if the transitions are known, so compute() does not need the operators. */
+    bool hasTransitions(void) const;
 
     /** Returns a sum of all the terms with a substituted frequency.
     * \param[in] z Input frequency
@@ -36,6 +36,12 @@ class Hamiltonian : public ComputableObject
     const StatesClassification& S;
     /** A value of the ground energy - needed for further renormalization */
     RealType GroundEnergy;
+    /** The ranks which hold the symbolic structure of each part after prepare(). */
+    std::vector<int> PartOwners;
+    /** A directory for the scratch files of the eigenvectors. Empty if the eigenvectors are kept in memory. */
+    std::string ScratchDirectory;
+    /** The thresholds of the choice of the eigensolver for all parts. */
+    EigensolverPolicy Policy;
 public:
 
     /** Constructor. */
@@ -45,8 +51,47 @@ public:
 
     void prepare(const boost::mpi::communicator &comm = boost::mpi::communicator());
     void compute(const boost::mpi::communicator &comm = boost::mpi::communicator());
+    /** Compute the eigenvalues of all parts without the eigenvectors, e.g. for the Thermodynamics.
+     * The eigenvectors are not available afterwards, so the field operators can not be computed. */
+    void computeEigenValues(const boost::mpi::communicator &comm = boost::mpi::communicator());
     void reduce(const RealType Cutoff);
 
+    /** Refill all parts with new values of the terms of F, keeping the block structure and the positions of the nonzero elements.
+     * The Hamiltonian is returned to the Prepared state and has to be computed again.
+     * \param[in] Coefficients The coefficients of the terms of F, in the order of iteration over F.
+     * \param[in] WarmStart If true, the next compute() starts from the current eigenvectors and falls back 
+     * to the full diagonalization only for the parts, where they are far from the new ones. */
+    void update(const std::vector<MelemType>& Coefficients, bool WarmStart = false, const boost::mpi::communicator &comm = boost::mpi::communicator());
+    /** Refill all parts with the coefficients of the terms of a new Operator.
+     * Every term of NewF must be present in F, the terms of F absent in NewF are set to zero.
+     * \param[in] NewF An operator with the same symmetries and terms as F, e.g. an IndexHamiltonian for a new set of parameters. */
+    void update(const Operator& NewF, bool WarmStart = false, const boost::mpi::communicator &comm = boost::mpi::communicator());
+
+    /** Add a term, which is a function of the conserved quantities (like mu*N or h*Sz), to the computed Hamiltonian.
+     * Such a term is constant within each part, so only the eigenvalues and the ground energy are shifted, 
+     * the eigenvectors are kept. The DensityMatrix has to be updated afterwards. F is not changed.
+     * \param[in] Shift An operator, which is diagonal in the FockState basis and constant within each part. */
+    void shift(const Operator& Shift);
+
+    /** Set the thresholds of the choice of the eigensolver for all parts. Takes effect in the next compute(). */
+    void setEigensolverPolicy(const EigensolverPolicy& Policy);
+    /** Return the thresholds of the choice of the eigensolver. */
+    const EigensolverPolicy& getEigensolverPolicy() const;
+
+    /** Keep the eigenvectors of all parts in memory-mapped scratch files in Directory (see HamiltonianPart::spill).
+     * The computed parts are spilled immediately, the parts computed later are spilled as soon as they are distributed,
+     * so the eigenvectors of the whole Hamiltonian never have to fit into memory at once.
+     * \param[in] Directory A directory on a local disk, or an empty string to keep the eigenvectors in memory. */
+    void setScratchDirectory(const std::string& Directory);
+    /** Store the eigenvectors of all parts in single precision (see HamiltonianPart::compress). 
+     * Call it after all field operators are computed. Requires POMEROL_FLOAT_STORAGE, otherwise does nothing.
+     * Returns the largest deviation of the compressed eigenvectors from the ones in double precision. */
+    RealType compress(void);
+    /** Release the eigenvectors of the given parts (see HamiltonianPart::releaseEigenvectors), which are not referenced 
+     * by the field operator parts to be computed, see FieldOperatorContainer::getUnusedBlocks. The eigenvalues are kept.
+     * \param[in] Blocks The BlockNumbers of the parts. */
+    void releaseEigenvectors(const std::set<BlockNumber>& Blocks);
+
     const HamiltonianPart& getPart(const QuantumNumbers &in) const;
     const HamiltonianPart& getPart(BlockNumber in) const;
     RealType getEigenValue(unsigned long state) const;
@@ -18,6 +18,22 @@
 
 namespace Pomerol{
 
+/** The thresholds, which define the choice of the eigensolver for each HamiltonianPart.
+ * The nonzero elements of a part are analyzed before the diagonalization : the states, which are not connected by H,
+ * form independent subblocks. A subblock of a single state is already diagonal, a subblock, 
+ * where the states form a chain, is tridiagonal in the order of the chain. Other subblocks are diagonalized by the dense solver. */
+struct EigensolverPolicy {
+    /** The matrix elements, smaller than ZeroTolerance times the largest matrix element, do not connect the states. */
+    RealType ZeroTolerance;
+    /** The parts smaller than this size are passed to the dense solver without the analysis. */
+    InnerQuantumState MinAnalysisSize;
+    /** Diagonalize the independent subblocks separately. */
+    bool Decompose;
+    /** Use the tridiagonal solver for the chains of states. */
+    bool Tridiagonal;
+    EigensolverPolicy():ZeroTolerance(100*std::numeric_limits<RealType>::epsilon()), MinAnalysisSize(2), Decompose(true), Tridiagonal(true){};
+};
+
 /** HamiltonianPart is a class, which stores and diagonalizes the block of the Hamiltonian, which corresponds to a set of given quantum numbers. */
 class HamiltonianPart : public ComputableObject {
 
@@ -34,11 +50,70 @@ class HamiltonianPart : public ComputableObject {
     QuantumNumbers QN;
 
     /** A matrix filled with matrix elements of HamiltonianPart in the space of FockState's.
-     *  After diagonalization it stores the eigenfunctions of the problem in a rows of H. */
-    MatrixType H;                
+     *  After diagonalization it stores the eigenfunctions of the problem in the columns of H. 
+     *  The storage is column-major, so each eigenvector is contiguous in memory.
+     *  After reduce() only the columns of the retained eigenstates are kept, so H becomes rectangular. */
+    ColMajorDenseMatrixType H;                
     /** A vector of eigenvalues of the HamiltonianPart. */
     RealVectorType Eigenvalues;      
 
+    /** A single contribution of a term of the IndexHamiltonian to a nonzero matrix element of H. */
+    struct PatternEntry {
+        /** Position of the matrix element in H. */
+        InnerQuantumState Row, Col;
+        /** Index of the contributing term in the order of iteration over F. */
+        size_t Term;
+        /** The fermionic sign of the term acting between the two FockStates. */
+        RealType Sign;
+        PatternEntry(InnerQuantumState Row, InnerQuantumState Col, size_t Term, RealType Sign):Row(Row),Col(Col),Term(Term),Sign(Sign){};
+        bool operator<(const PatternEntry& rhs) const { return (Col < rhs.Col || (Col == rhs.Col && Row < rhs.Row)); };
+    };
+    /** The symbolic structure of H : all nonzero contributions sorted by their position in H. */
+    std::vector<PatternEntry> Pattern;
+
+    /** True if all matrix elements of H are real. Such parts are diagonalized with a real solver, their eigenvectors are real 
+     * and the operators between two real parts are rotated in real arithmetic. Always true without POMEROL_COMPLEX_MATRIX_ELEMENTS. */
+    bool RealValued;
+
+public:
+    /** The eigensolvers, which can be chosen for a part. */
+    enum SolverType {Dense, Diagonal, Tridiagonal, BlockDiagonal, WarmStart};
+private:
+    /** The thresholds of the choice of the eigensolver. */
+    EigensolverPolicy Policy;
+    /** The eigensolver, which has diagonalized the part. */
+    SolverType Solver;
+    /** Find the independent subblocks of H, diagonalize each of them with the solver chosen by the Policy
+     * and collect the eigenvalues in ascending order. 
+     * \param[in] ComputeVectors If true, the eigenvectors are stored in the columns of H. */
+    void diagonalize(bool ComputeVectors);
+    /** Diagonalize a single subblock M. The eigenvalues are not necessarily sorted.
+     * \param[in] Chain True if M is tridiagonal. */
+    SolverType solveBlock(const ColMajorDenseMatrixType& M, bool Chain, bool ComputeVectors, RealVectorType& Values, ColMajorDenseMatrixType& Vectors) const;
+
+    /** Eigenvectors of the previous compute() kept as a starting point for the next diagonalization. Empty if not used. */
+    ColMajorDenseMatrixType PreviousEigenvectors;
+    /** Try to diagonalize H by a few Jacobi rotations in the basis of PreviousEigenvectors.
+     * Returns false if the previous basis is too far from the new one. */
+    bool computeWarmStart(void);
+
+    /** The eigenvectors spilled to a scratch file by spill() and mapped into memory. Null if H is kept in memory. */
+    MelemType *Mapped;
+    /** The dimensions of the mapped eigenvector matrix. */
+    InnerQuantumState MappedRows, MappedCols;
+    #ifdef POMEROL_FLOAT_STORAGE
+    /** The eigenvectors in single precision after compress(). Empty if H is kept in double precision. */
+    StorageColMajorDenseMatrixType CompressedH;
+    #endif
+    /** Copy the mapped or the compressed eigenvectors back to H and release the mapping. */
+    void restore(void);
+    /** Release the mapping and the compressed eigenvectors without reading them. */
+    void releaseScratch(void);
+
+    /** The part owns its mapping, so it is not copyable. */
+    HamiltonianPart(const HamiltonianPart&);
+    HamiltonianPart& operator=(const HamiltonianPart&);
+
     friend class Hamiltonian;
 
 public:
@@ -49,16 +124,51 @@ public:
      * \param[in] S StatesClassification object. Provides information about Fock States of the problem.
      * \param[in] Block The BlockNumber of current part. It is a genuine id of the part. */
     HamiltonianPart(const IndexClassification &IndexInfo, const IndexHamiltonian &F, const StatesClassification &S, const BlockNumber& Block);
+    /** Destructor. Releases the scratch file of the eigenvectors. */
+    ~HamiltonianPart();
 
-    /** Fill in the H matrix. */
+    /** Fill in the H matrix. Calls prepareStructure() and refill() with the coefficients of F. */
     void prepare(void);
+    /** Symbolic phase : record the positions of the nonzero elements of H and the terms of F contributing to them. */
+    void prepareStructure(void);
+    /** Numeric phase : refill the H matrix from the recorded structure in a single pass.
+     * \param[in] Coefficients The coefficients of the terms of F, in the order of iteration over F. */
+    void refill(const std::vector<MelemType>& Coefficients);
     /** Diagonalize the H matrix and get EigenValues. */
     void compute(void);
+    /** Get the EigenValues of the H matrix only. The H matrix is released afterwards, so no eigenvectors are available. */
+    void computeEigenValues(void);
     
-    bool reduce(RealType ActualCutoff); // Useless now
+    /** Keep only the eigenstates with the energies not larger than ActualCutoff. 
+     * Returns false if no eigenstates are left. */
+    bool reduce(RealType ActualCutoff);
+
+    /** Move the eigenvectors out of memory into a scratch file in Directory, which is then mapped read-only.
+     * The pages are read by the OS on demand, so only the eigenvectors being used occupy memory.
+     * The file is unlinked immediately and disappears with the part.
+     * \param[in] Directory A directory on a local disk. */
+    void spill(const std::string& Directory);
+    /** Return true if the eigenvectors are kept in a scratch file. */
+    bool isSpilled(void) const;
+    /** Drop the pages of the spilled eigenvectors from memory. They are read from the scratch file again on the next access. */
+    void evict(void) const;
+    /** Store the eigenvectors in single precision to halve their memory, once the operators are rotated to the eigenbasis. 
+     * Does nothing without POMEROL_FLOAT_STORAGE. getMatrix() and getEigenState() are not available for the compressed part, 
+     * getMatrixElement() returns the values converted to MelemType and getCompressedMatrix() gives the stored values.
+     * Returns the largest deviation of the compressed eigenvectors from the ones in double precision. */
+    RealType compress(void);
+    /** Return true if the eigenvectors are stored in single precision. */
+    bool isCompressed(void) const;
+    /** Release the eigenvectors, e.g. once the field operator parts between this block and others are computed.
+     * The eigenvalues are kept. */
+    void releaseEigenvectors(void);
+    /** Return true if the eigenvectors are available, i.e. neither computeEigenValues() nor releaseEigenvectors() was called. */
+    bool hasEigenvectors(void) const;
 
     /** Return the total dimensionality of the H matrix. This corresponds to the one in StatesClassfication. */
     InnerQuantumState getSize(void) const;
+    /** Return the number of eigenstates of the part. Differs from getSize() after reduce(). */
+    InnerQuantumState getNumberOfEigenStates(void) const;
 
     /** Get the matrix element of the HamiltonianPart by the number of states inside the part. */ 
     MelemType getMatrixElement(InnerQuantumState m, InnerQuantumState n) const; //return H(m,n)
@@ -72,14 +182,24 @@ public:
     /** Returns calculated eigenvalues. */
     const RealVectorType& getEigenValues() const; 
 
-    /** Return the hamiltonian part matrix. */
-    const MatrixType& getMatrix() const;
+    /** Return a view of the hamiltonian part matrix. A view of the scratch file if the part is spilled. Throws if the part is compressed. */
+    Eigen::Map<const ColMajorDenseMatrixType> getMatrix() const;
+    #ifdef POMEROL_FLOAT_STORAGE
+    /** Return the eigenvectors stored in single precision by compress(). Empty if the part is not compressed. */
+    const StorageColMajorDenseMatrixType& getCompressedMatrix() const;
+    #endif
+
+    /** Return the eigensolver, which has diagonalized the part. */
+    SolverType getSolver() const;
+
+    /** Return true if the matrix elements of the part and its eigenvectors are real. */
+    bool isReal() const;
 
     /** Return the lowest Eigenvalue of the current part. */
     RealType getMinimumEigenvalue() const;        
-    /** Return the eigenstate of the H matrix.
+    /** Return a view of the eigenstate of the H matrix. The eigenstate is not copied. Throws if the part is compressed.
      * \param[in] Number of eigenvalue. */
-    VectorType getEigenState(InnerQuantumState state) const;
+    Eigen::Map<const VectorType> getEigenState(InnerQuantumState state) const;
 
     /** Return the QuantumNumbers associated with the Hamiltonian part. */
     QuantumNumbers getQuantumNumbers() const; 
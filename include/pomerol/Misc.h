@@ -68,6 +68,16 @@ typedef ComplexType MelemType;
 typedef RealType MelemType;
 #endif
 
+/** Type of the stored matrix elements of the operators in the eigenbasis and of the compressed eigenvectors.
+ * Single precision with POMEROL_FLOAT_STORAGE, the arithmetic is always done in MelemType. */
+#ifndef POMEROL_FLOAT_STORAGE
+typedef MelemType StorageMelemType;
+#elif defined(POMEROL_COMPLEX_MATRIX_ELEMENTS)
+typedef std::complex<float> StorageMelemType;
+#else
+typedef float StorageMelemType;
+#endif
+
 /** Index represents a combination of spin, orbital, and lattice indices **/
 typedef unsigned int ParticleIndex;
 
@@ -102,6 +112,14 @@ typedef Eigen::Matrix<RealType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Ei
 typedef Eigen::Matrix<RealType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::RowMajor> LowerTriangularRealMatrixType;
 /** Default Matrix Type comes from MelemType. */
 typedef Eigen::Matrix<MelemType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::RowMajor> MatrixType;
+/** Dense matrix of the stored values. */
+typedef Eigen::Matrix<StorageMelemType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::RowMajor> StorageMatrixType;
+/** Dense matrix with contiguous columns, e.g. for the eigenvectors, which are stored in the columns. */
+typedef Eigen::Matrix<MelemType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::ColMajor> ColMajorDenseMatrixType;
+/** Dense real matrix with contiguous columns. */
+typedef Eigen::Matrix<RealType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::ColMajor> RealColMajorDenseMatrixType;
+/** Dense matrix of the stored values with contiguous columns. */
+typedef Eigen::Matrix<StorageMelemType,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::ColMajor> StorageColMajorDenseMatrixType;
 
 /** Dense complex vector. */
 typedef Eigen::Matrix<ComplexType,Eigen::Dynamic,1,Eigen::AutoAlign> ComplexVectorType;
@@ -113,8 +131,8 @@ typedef Eigen::Matrix<int,Eigen::Dynamic,1,Eigen::AutoAlign> IntVectorType;
 typedef Eigen::Matrix<MelemType,Eigen::Dynamic,1,Eigen::AutoAlign> VectorType;
 
 /** Sparse complex matrix */
-typedef Eigen::SparseMatrix<MelemType,Eigen::ColMajor> ColMajorMatrixType;
-typedef Eigen::SparseMatrix<MelemType,Eigen::RowMajor> RowMajorMatrixType;
+typedef Eigen::SparseMatrix<StorageMelemType,Eigen::ColMajor> ColMajorMatrixType;
+typedef Eigen::SparseMatrix<StorageMelemType,Eigen::RowMajor> RowMajorMatrixType;
 typedef Eigen::DynamicSparseMatrix<MelemType,Eigen::ColMajor> DynamicSparseMatrixType;
 //typedef Eigen::Triplet<RealType> RealTypeTriplet;
 //typedef Eigen::Triplet<ComplexType> ComplexTypeTriplet;
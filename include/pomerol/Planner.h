@@ -0,0 +1,133 @@
+/** \file include/pomerol/Planner.h
+** \brief A dry run of the calculation : projected sizes, memory and cost of all stages.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+#ifndef __INCLUDE_PLANNER_H
+#define __INCLUDE_PLANNER_H
+
+#include "Misc.h"
+#include "ComputableObject.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "StatesClassification.h"
+
+#include <set>
+
+namespace Pomerol{
+
+/** This class estimates the resources of a calculation before anything is diagonalized.
+ * Only the block structure from the StatesClassification is used : the connections of the blocks by the field operators
+ * are found in the same way as in FieldOperator::prepare, but no matrices are allocated.
+ * The estimates are upper bounds : the operators are assumed to be dense in the eigenbasis and the terms of
+ * the Green's functions are counted before the thresholds and the reduction of the terms.
+ * The report is available as a human readable table and in JSON format.
+ */
+class Planner : public ComputableObject
+{
+public:
+    /** Projected resources of a diagonalization of a single block of the Hamiltonian. */
+    struct BlockEstimate {
+        BlockNumber Block;
+        QuantumNumbers QN;
+        InnerQuantumState Size;
+        /** Flops of the dense eigen-decomposition with eigenvectors. */
+        RealType Flops;
+        /** Bytes of the eigenvectors and eigenvalues, kept after the diagonalization. */
+        RealType Bytes;
+        /** Bytes used during the diagonalization : the matrix, the eigenvectors and the workspace of the solver. */
+        RealType PeakBytes;
+        BlockEstimate(BlockNumber Block, const QuantumNumbers& QN, InnerQuantumState Size);
+    };
+
+    /** Projected resources of a pair of field operators c_i and c^+_i. */
+    struct OperatorEstimate {
+        ParticleIndex Index;
+        /** The number of FieldOperatorParts of c^+_i. c_i has the same number of parts. */
+        size_t Parts;
+        /** The number of stored matrix elements of c^+_i, assuming dense parts. */
+        RealType NonZeros;
+        /** Bytes of the stored matrix elements of c^+_i, which are shared by c_i. */
+        RealType Bytes;
+        /** Flops of the rotation of c^+_i to the eigenbasis. */
+        RealType Flops;
+    };
+
+    /** Projected size of a Green's function. */
+    struct GFEstimate {
+        IndexCombination2 Indices;
+        size_t Parts;
+        /** The largest number of terms (poles) of the Green's function. */
+        RealType Terms;
+        RealType Bytes;
+        GFEstimate(const IndexCombination2& Indices):Indices(Indices),Parts(0),Terms(0),Bytes(0){};
+    };
+
+    /** Projected size of a two-particle Green's function. */
+    struct TwoParticleGFEstimate {
+        IndexCombination4 Indices;
+        size_t Parts;
+        /** The largest number of terms before the reduction of the terms with equal poles. */
+        RealType Terms;
+        RealType Bytes;
+        TwoParticleGFEstimate(const IndexCombination4& Indices):Indices(Indices),Parts(0),Terms(0),Bytes(0){};
+    };
+
+private:
+    /** A reference to an IndexClassification object. */
+    const IndexClassification &IndexInfo;
+    /** A reference to a states classification object. */
+    const StatesClassification &S;
+
+    /** The block, to which c^+_i maps each block, for every index i. */
+    std::map<ParticleIndex, std::map<BlockNumber, BlockNumber> > CdagMaps;
+    /** The block, to which c_i maps each block, for every index i. */
+    std::map<ParticleIndex, std::map<BlockNumber, BlockNumber> > CMaps;
+
+    std::vector<BlockEstimate> Blocks;
+    std::vector<OperatorEstimate> Operators;
+    std::vector<GFEstimate> GFs;
+    std::vector<TwoParticleGFEstimate> TwoParticleGFs;
+
+    /** Find the block connections of c_i and c^+_i. */
+    void mapBlocks(ParticleIndex Index);
+    /** Return the block, to which an operator maps a given block, or ERROR_BLOCK_NUMBER. */
+    BlockNumber mapsTo(const std::map<BlockNumber, BlockNumber>& Map, BlockNumber Right) const;
+    /** The block, to which the operator at a position in a permutation of (c_1, c_2, c^+_3) maps a given block. */
+    BlockNumber mapsTo(const IndexCombination4& Indices, size_t Operator, BlockNumber Right) const;
+
+public:
+    /** Constructor.
+     * \param[in] IndexInfo A reference to an IndexClassification object.
+     * \param[in] S A reference to a computed states classification object.
+     */
+    Planner(const IndexClassification &IndexInfo, const StatesClassification &S);
+
+    /** Estimate the resources of the diagonalization of all blocks and of the requested quantities.
+     * \param[in] Indices The indices of the field operators to be computed.
+     * \param[in] GFIndices The index combinations of the Green's functions.
+     * \param[in] TwoParticleGFIndices The index combinations of the two-particle Green's functions.
+     */
+    void compute(const std::set<ParticleIndex>& Indices,
+                 const std::set<IndexCombination2>& GFIndices = std::set<IndexCombination2>(),
+                 const std::set<IndexCombination4>& TwoParticleGFIndices = std::set<IndexCombination4>());
+
+    const std::vector<BlockEstimate>& getBlocks() const;
+    const std::vector<OperatorEstimate>& getOperators() const;
+    const std::vector<GFEstimate>& getGFs() const;
+    const std::vector<TwoParticleGFEstimate>& getTwoParticleGFs() const;
+
+    /** Returns the total flops of the diagonalization of the Hamiltonian. */
+    RealType getDiagonalizationFlops() const;
+    /** Returns the largest memory of the run : all eigenvectors, the workspace of the largest block,
+     * all field operators and the terms of all Green's functions. */
+    RealType getPeakBytes() const;
+
+    /** Print a human readable report. */
+    void print(std::ostream& out) const;
+    /** Print the report as a JSON object. */
+    void printJSON(std::ostream& out) const;
+};
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_PLANNER_H
@@ -0,0 +1,137 @@
+/** \file include/pomerol/Susceptibility.h
+** \brief Dynamical susceptibility of two bosonic operators.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+#ifndef __INCLUDE_SUSCEPTIBILITY_H
+#define __INCLUDE_SUSCEPTIBILITY_H
+
+#include"Misc.h"
+#include"Thermal.h"
+#include"ComputableObject.h"
+#include"StatesClassification.h"
+#include"FieldOperator.h"
+#include"DensityMatrix.h"
+#include"SusceptibilityPart.h"
+
+namespace Pomerol{
+
+/** This class represents a dynamical susceptibility in the Matsubara representation.
+ *
+ * Exact definition:
+ *
+ * \f[
+ *      \chi(\Omega_n) = \int_0^\beta \langle\mathbf{T}A(\tau)B(0)\rangle e^{i\Omega_n\tau} d\tau
+ * \f]
+ *
+ * A and B are bosonic operators, e.g. QuadraticOperator's, so \f$ \Omega_n = 2\pi n/\beta \f$.
+ * The calculation is a single sum over the pairs of eigenstates, like the one of a GreensFunction.
+ * The transitions between the states with equal energies contribute only at \f$ \Omega_0 = 0 \f$.
+ *
+ * It is actually a container class for a collection of parts. A pair of parts, one part of A and
+ * another of B, which maps the blocks back, corresponds to a part of the susceptibility.
+ */
+class Susceptibility : public Thermal, public ComputableObject {
+
+    /** A reference to a states classification object. */
+    const StatesClassification& S;
+    /** A reference to a Hamiltonian. */
+    const Hamiltonian& H;
+    /** A reference to the operator A. */
+    const FieldOperator& A;
+    /** A reference to the operator B. */
+    const FieldOperator& B;
+    /** A reference to a density matrix. */
+    const DensityMatrix& DM;
+
+    /** A flag to represent if the susceptibility vanishes, i.e. identical to 0 */
+    bool Vanishing;
+
+    /** A list of pointers to parts. */
+    std::list<SusceptibilityPart*> parts;
+
+    /** The product of the averages of A and B, which is subtracted from the susceptibility. 0 by default. */
+    ComplexType Disconnected;
+
+    /** Returns the thermal average of an operator from its parts, which map a block to itself. */
+    ComplexType getAverage(const FieldOperator& O) const;
+
+public:
+     /** Constructor.
+     * \param[in] S A reference to a states classification object.
+     * \param[in] H A reference to a Hamiltonian.
+     * \param[in] A A reference to a computed operator A.
+     * \param[in] B A reference to a computed operator B.
+     * \param[in] DM A reference to a density matrix.
+     */
+    Susceptibility(const StatesClassification& S, const Hamiltonian& H,
+                   const FieldOperator& A, const FieldOperator& B, const DensityMatrix& DM);
+    /** Copy-constructor.
+     * \param[in] Chi Susceptibility object to be copied.
+     */
+    Susceptibility(const Susceptibility& Chi);
+    /** Constructs the susceptibility at the temperature of another density matrix. The parts share the transitions
+     * with the parts of Chi, so compute() only weights them. The disconnected part is not copied, it depends on the temperature.
+     * The density matrix should not retain the blocks, which are truncated by the density matrix of Chi.
+     * \param[in] Chi A prepared susceptibility.
+     * \param[in] DM A reference to a computed density matrix.
+     */
+    Susceptibility(const Susceptibility& Chi, const DensityMatrix& DM);
+    /** Destructor. */
+    ~Susceptibility();
+
+    /** Chooses relevant parts of A and B and allocates resources for the parts of the susceptibility. */
+    void prepare(void);
+    /** Actually computes the parts. */
+    void compute();
+    /** Recomputes the parts after the Hamiltonian, the density matrix and the operators have been updated. The parts are kept. */
+    void update();
+
+    /** Subtract the disconnected part \f$ \langle A\rangle\langle B\rangle \f$, calculated from the diagonal blocks of A and B. */
+    void subtractDisconnected();
+    /** Subtract the disconnected part \f$ \langle A\rangle\langle B\rangle \f$ for given averages of A and B. */
+    void subtractDisconnected(ComplexType AverageA, ComplexType AverageB);
+
+     /** Returns the value of the susceptibility calculated at a given bosonic frequency.
+     * \param[in] MatsubaraNum Number of the Matsubara frequency (\f$ \Omega_n = 2\pi n/\beta \f$).
+     */
+    ComplexType operator()(long MatsubaraNumber) const;
+     /** Returns the value of the susceptibility calculated at a given frequency. The resonant transitions
+     * and the disconnected part are not included, they contribute only at the zero Matsubara frequency.
+     * \param[in] z Input frequency
+     */
+    ComplexType operator()(ComplexType z) const;
+     /** Returns the value of the susceptibility calculated at a given imaginary time point.
+     * \param[in] tau Imaginary time point.
+     */
+    ComplexType of_tau(RealType tau) const;
+
+    bool isVanishing(void) const;
+};
+
+inline ComplexType Susceptibility::operator()(long int MatsubaraNumber) const {
+    ComplexType Value = (MatsubaraNumber == 0 ? -beta*Disconnected : 0);
+    if(Vanishing) return Value;
+    for(std::list<SusceptibilityPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Value += (**iter)(MatsubaraNumber);
+    return Value;
+}
+
+inline ComplexType Susceptibility::operator()(ComplexType z) const {
+    ComplexType Value = 0;
+    if(Vanishing) return Value;
+    for(std::list<SusceptibilityPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Value += (**iter)(z);
+    return Value;
+}
+
+inline ComplexType Susceptibility::of_tau(RealType tau) const {
+    ComplexType Value = -Disconnected;
+    if(Vanishing) return Value;
+    for(std::list<SusceptibilityPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Value += (*iter)->of_tau(tau);
+    return Value;
+}
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_SUSCEPTIBILITY_H
@@ -0,0 +1,190 @@
+/** \file include/pomerol/SusceptibilityPart.h
+** \brief Part of a dynamical susceptibility for a given pair of Hamiltonian blocks.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+#ifndef __INCLUDE_SUSCEPTIBILITYPART_H
+#define __INCLUDE_SUSCEPTIBILITYPART_H
+
+#include<cmath>
+#include<vector>
+#include<boost/shared_ptr.hpp>
+
+#include"Misc.h"
+#include"StatesClassification.h"
+#include"HamiltonianPart.h"
+#include"FieldOperator.h"
+#include"DensityMatrixPart.h"
+#include"DensityMatrix.h"
+#include"TermList.h"
+
+namespace Pomerol{
+
+/** This class represents a part of a dynamical susceptibility \f$ \langle\mathbf{T}A(\tau)B\rangle \f$.
+ * Every part describes all transitions allowed by selection rules between a given pair of Hamiltonian blocks.
+ * The transitions between the states with equal energies contribute only at the zero bosonic frequency,
+ * their total weight is kept separately from the terms.
+ */
+class SusceptibilityPart : public Thermal
+{
+    /** A reference to a part of a Hamiltonian (inner index iterates through it). */
+    const HamiltonianPart& HpartInner;
+    /** A reference to a part of a Hamiltonian (outer index iterates through it). */
+    const HamiltonianPart& HpartOuter;
+    /** A reference to a part of a density matrix (the part corresponding to HpartInner). */
+    const DensityMatrixPart& DMpartInner;
+    /** A reference to a part of a density matrix (the part corresponding to HpartOuter). */
+    const DensityMatrixPart& DMpartOuter;
+
+    /** A reference to a part of the operator A, it maps the inner block to the outer one. */
+    const FieldOperatorPart& A;
+    /** A reference to a part of the operator B, it maps the outer block to the inner one. */
+    const FieldOperatorPart& B;
+
+    /** Every term is a fraction \f$ \frac{R}{z - P} \f$. */
+    struct Term {
+        /** Residue at the pole (\f$ R \f$). */
+        ComplexType Residue;
+        /** Position of the pole (\f$ P \f$). */
+        RealType Pole;
+
+        /** Comparator object for terms */
+        struct Compare {
+            const double Tolerance;
+            Compare(double Tolerance) : Tolerance(Tolerance) {}
+            bool operator()(Term const& t1, Term const& t2) const {
+                return t2.Pole - t1.Pole >= Tolerance;
+            }
+        };
+
+        /** Does term have a negligible residue? */
+        struct IsNegligible {
+            double Tolerance;
+            IsNegligible(double Tolerance) : Tolerance(Tolerance) {}
+            bool operator()(Term const& t, size_t ToleranceDivisor) const {
+                return std::abs(t.Residue) < Tolerance / ToleranceDivisor;
+            }
+            friend class boost::serialization::access;
+            template<class Archive> void serialize(Archive & ar, const unsigned int version) {
+                ar & Tolerance;
+            }
+        };
+
+        /** Constructor.
+        * \param[in] Residue Value of the residue.
+        * \param[in] Pole Position of the pole.
+        */
+        Term(ComplexType Residue, RealType Pole);
+        /** Returns a contribution to the susceptibility made by this term.
+        * \param[in] Frequency Complex frequency \f$ z \f$ to substitute into this term.
+        */
+        ComplexType operator()(ComplexType Frequency) const;
+        /** Returns a contribution to the imaginary-time susceptibility made by this term.
+        * \param[in] tau Imaginary time point.
+        * \param[in] beta Inverse temperature.
+        */
+        ComplexType operator()(RealType tau, RealType beta) const;
+
+        /** This operator add a term to this one.
+        * It does not check the similarity of the terms!
+        * \param[in] AnotherTerm Another term to add to this.
+        */
+        Term& operator+=(const Term& AnotherTerm);
+    };
+
+    /** A stream insertion operator for type Term.
+     * \param[in] out An output stream to insert to.
+     * \param[in] Term A term to be inserted.
+     */
+    friend std::ostream& operator<< (std::ostream& out, const Term& T);
+
+    /** A list of all terms. */
+    TermList<Term> Terms;
+    /** The total weight of the transitions between the states with equal energies.
+     * It is the value of the resonant contribution at the zero frequency. */
+    ComplexType ZeroPoleWeight;
+
+    /** A transition between an outer and an inner eigenstate, it does not depend on the temperature. */
+    struct Transition {
+        /** The outer eigenstate. */
+        InnerQuantumState Outer;
+        /** The inner eigenstate. */
+        InnerQuantumState Inner;
+        /** The product of the matrix elements \f$ \langle outer|A|inner\rangle\langle inner|B|outer\rangle \f$. */
+        MelemType MatrixElement;
+        /** The difference of the energies \f$ E_{inner} - E_{outer} \f$. */
+        RealType Pole;
+
+        Transition(InnerQuantumState Outer, InnerQuantumState Inner, MelemType MatrixElement, RealType Pole) :
+            Outer(Outer), Inner(Inner), MatrixElement(MatrixElement), Pole(Pole) {}
+    };
+    /** The transitions of the part. They are shared with the parts of the susceptibility at other temperatures. */
+    boost::shared_ptr<std::vector<Transition> > Transitions;
+
+    /** Fills the list of terms and the weight of the zero pole from the transitions and the weights of the density matrix. */
+    void computeTerms(void);
+
+    /** A matrix element with magnitude less than this value is treated as zero. */
+    const RealType MatrixElementTolerance; // 1e-8;
+
+public:
+    /** Constructor.
+     * \param[in] A A reference to a part of the operator A.
+     * \param[in] B A reference to a part of the operator B.
+     * \param[in] HpartInner A reference to a part of the Hamiltonian (inner index).
+     * \param[in] HpartOuter A reference to a part of the Hamiltonian (outer index).
+     * \param[in] DMpartInner A reference to a part of the density matrix (inner index).
+     * \param[in] DMpartOuter A reference to a part of the density matrix (outer index).
+     */
+    SusceptibilityPart(const FieldOperatorPart& A, const FieldOperatorPart& B,
+                       const HamiltonianPart& HpartInner, const HamiltonianPart& HpartOuter,
+                       const DensityMatrixPart& DMpartInner, const DensityMatrixPart& DMpartOuter);
+    /** Constructs the part at the temperature of another density matrix. The transitions are shared with Part.
+     * \param[in] Part A part of the susceptibility at another temperature.
+     * \param[in] DM A reference to a density matrix.
+     */
+    SusceptibilityPart(const SusceptibilityPart& Part, const DensityMatrix& DM);
+
+    /** Iterates over all matrix elements and stores the transitions with non-zero matrix elements. */
+    void computeTransitions(void);
+    /** Fills the list of terms. The transitions are found first, unless they are known already. */
+    void compute(void);
+
+    /** Returns a sum of all the terms with a substituted frequency. The resonant transitions are not included.
+    * \param[in] z Input frequency
+    */
+    ComplexType operator()(ComplexType z) const;
+    /** Returns a sum of all the terms with a substituted bosonic Matsubara frequency.
+    * \param[in] MatsubaraNum Number of the Matsubara frequency (\f$ \Omega_n = 2\pi n/\beta \f$).
+    */
+    ComplexType operator()(long MatsubaraNumber) const;
+    /** Returns a sum of all the terms with a substituted imaginary time point.
+     * \param[in] tau Imaginary time point.
+     */
+    ComplexType of_tau(RealType tau) const;
+
+    /** A difference in energies with magnitude less than this value is treated as zero. */
+    const RealType ReduceResonanceTolerance;
+    /** Minimal magnitude of the coefficient of a term to take it into account with respect to amount of terms. */
+    const RealType ReduceTolerance;
+};
+
+std::ostream& operator<< (std::ostream& out, const SusceptibilityPart::Term& T);
+
+// Inline call operators
+inline ComplexType SusceptibilityPart::operator()(long MatsubaraNumber) const {
+    ComplexType Value = (*this)(MatsubaraSpacing*RealType(2*MatsubaraNumber));
+    if (MatsubaraNumber == 0) Value += ZeroPoleWeight;
+    return Value;
+}
+
+inline ComplexType SusceptibilityPart::operator()(ComplexType z) const {
+    return Terms(z);
+}
+
+inline ComplexType SusceptibilityPart::of_tau(RealType tau) const {
+    return Terms(tau, beta) + ZeroPoleWeight / beta;
+}
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_SUSCEPTIBILITYPART_H
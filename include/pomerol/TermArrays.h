@@ -0,0 +1,82 @@
+/** \file include/pomerol/TermArrays.h
+** \brief Terms of a Lehmann representation stored as contiguous arrays.
+**
+** \author Igor Krivenko (Igor.S.Krivenko@gmail.com)
+*/
+#ifndef __INCLUDE_TERMARRAYS_H
+#define __INCLUDE_TERMARRAYS_H
+
+#include "Misc.h"
+
+namespace Pomerol {
+
+/** A frozen sum of fractions \f$ \sum_k \frac{R_k}{z - P_k} \f$.
+ *
+ * The poles and the real and imaginary parts of the residues are stored as separate contiguous arrays,
+ * so the sum over the terms is evaluated by vectorized Eigen expressions instead of a walk over the nodes of a TermList.
+ * The arrays are filled once from the terms of all parts of a Green's function, see GreensFunction::compute.
+ */
+class TermArrays {
+
+    /** The positions of the poles in ascending order. */
+    RealVectorType Poles;
+    /** The real parts of the residues. */
+    RealVectorType ResiduesRe;
+    /** The imaginary parts of the residues. */
+    RealVectorType ResiduesIm;
+
+    /** Returns the sum of Length terms starting from Start at a given frequency. */
+    ComplexType sum(long Start, long Length, ComplexType z) const;
+
+public:
+
+    /** A term as a pair of the position of the pole and the residue. */
+    typedef std::pair<RealType, ComplexType> Term;
+
+    /** Constructor of an empty sum. */
+    TermArrays();
+
+    /** Fills the arrays from a list of terms. The terms are sorted by their poles, the terms with the poles closer than
+     * Tolerance to the first pole of a group are merged, like in TermList. The merged terms with residues not larger
+     * than Tolerance are dropped.
+     * \param[in] Terms The terms, e.g. of all parts of a Green's function.
+     * \param[in] Tolerance The tolerance of the poles and the residues.
+     */
+    void assign(std::vector<Term> Terms, RealType Tolerance);
+
+    /** Number of terms. */
+    size_t size() const;
+    /** Returns the position of the k-th pole. */
+    RealType getPole(size_t k) const;
+    /** Returns the residue at the k-th pole. */
+    ComplexType getResidue(size_t k) const;
+
+    /** Returns the sum of the terms at a given frequency.
+     * \param[in] z Input frequency.
+     */
+    ComplexType operator()(ComplexType z) const;
+    /** Returns the sums of the terms at a vector of frequencies.
+     * \param[in] z Input frequencies.
+     */
+    ComplexVectorType operator()(const ComplexVectorType& z) const;
+};
+
+inline ComplexType TermArrays::sum(long Start, long Length, ComplexType z) const
+{
+    // R/(z - P) = R (z - P)^* / |z - P|^2, the real and the imaginary parts are sums over the arrays.
+    // The expressions are evaluated in single passes over the arrays without temporaries.
+    RealType x = real(z), y = imag(z);
+    Eigen::VectorBlock<const RealVectorType> P = Poles.segment(Start, Length);
+    Eigen::VectorBlock<const RealVectorType> Re = ResiduesRe.segment(Start, Length);
+    Eigen::VectorBlock<const RealVectorType> Im = ResiduesIm.segment(Start, Length);
+    return ComplexType(((Im.array()*y - Re.array()*(P.array() - x)) / ((P.array() - x).square() + y*y)).sum(),
+                      -((Im.array()*(P.array() - x) + Re.array()*y) / ((P.array() - x).square() + y*y)).sum());
+}
+
+inline ComplexType TermArrays::operator()(ComplexType z) const
+{
+    return sum(0, Poles.size(), z);
+}
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_TERMARRAYS_H
@@ -64,6 +64,9 @@ public:
     /** Remove all terms from the container */
     void clear() { data.clear(); }
 
+    /** Read access to the terms, in the order of Compare */
+    std::set<TermType, Compare> const& as_set() const { return data; }
+
     // Some pre-C++11 ugliness ...
 #define MAKE_CALL_OPERATOR(N)                                               \
     template<BOOST_PP_ENUM_PARAMS(N, typename Arg)>                         \
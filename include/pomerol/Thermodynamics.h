@@ -0,0 +1,89 @@
+/** \file include/pomerol/Thermodynamics.h
+** \brief Thermodynamic quantities on a grid of temperatures.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+** \author Igor Krivenko (Igor.S.Krivenko@gmail.com)
+*/
+#ifndef __INCLUDE_THERMODYNAMICS_H
+#define __INCLUDE_THERMODYNAMICS_H
+
+#include "Misc.h"
+#include "ComputableObject.h"
+#include "IndexClassification.h"
+#include "StatesClassification.h"
+#include "Hamiltonian.h"
+
+namespace Pomerol{
+
+/** This class calculates the partition function, the energy, the specific heat, the entropy
+ * and the charge and spin susceptibilities for a set of inverse temperatures at once.
+ * Only the eigenvalues of the Hamiltonian are required, so it can be computed with Hamiltonian::computeEigenValues.
+ * The charge and the spin of an eigenstate are taken from the block it belongs to, therefore the susceptibilities
+ * are available only if the number of particles and the projection of the spin are conserved in every block.
+ */
+class Thermodynamics : public ComputableObject
+{
+    /** A reference to an IndexClassification object. Defines the spin of the indices. */
+    const IndexClassification &IndexInfo;
+    /** A reference to a states classification object. */
+    const StatesClassification &S;
+    /** A reference to a Hamiltonian. */
+    const Hamiltonian &H;
+
+    /** The grid of inverse temperatures. */
+    RealVectorType Betas;
+
+    /** Logarithm of the partition function \f$ \ln Z \f$. */
+    RealVectorType LogZ;
+    /** Average energy \f$ \langle H \rangle \f$. */
+    RealVectorType Energy;
+    /** Specific heat \f$ \beta^2 (\langle H^2 \rangle - \langle H \rangle^2) \f$. */
+    RealVectorType SpecificHeat;
+    /** Entropy \f$ \ln Z + \beta \langle H \rangle \f$. */
+    RealVectorType Entropy;
+    /** Average number of particles. */
+    RealVectorType Occupancy;
+    /** Charge susceptibility \f$ \beta (\langle N^2 \rangle - \langle N \rangle^2) \f$. */
+    RealVectorType ChargeSusceptibility;
+    /** Spin susceptibility \f$ \beta (\langle S_z^2 \rangle - \langle S_z \rangle^2) \f$. */
+    RealVectorType SpinSusceptibility;
+
+    /** True if every block has a definite number of particles. */
+    bool ChargeConserved;
+    /** True if every block has a definite projection of the spin. */
+    bool SpinConserved;
+
+public:
+    /** Constructor.
+     * \param[in] IndexInfo A reference to an IndexClassification object.
+     * \param[in] S A reference to a states classification object.
+     * \param[in] H A reference to a Hamiltonian with computed eigenvalues.
+     * \param[in] Betas A grid of inverse temperatures.
+     */
+    Thermodynamics(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, const std::vector<RealType> &Betas);
+
+    /** Evaluates all quantities for all temperatures in a single pass over the eigenvalues. */
+    void compute(void);
+
+    /** Returns the grid of inverse temperatures. */
+    const RealVectorType& getBetas(void) const;
+    /** Returns the logarithm of the partition function. */
+    const RealVectorType& getLogPartitionFunction(void) const;
+    /** Returns the free energy \f$ -\ln Z / \beta \f$. */
+    RealVectorType getFreeEnergy(void) const;
+    /** Returns the average energy. */
+    const RealVectorType& getEnergy(void) const;
+    /** Returns the specific heat. */
+    const RealVectorType& getSpecificHeat(void) const;
+    /** Returns the entropy. */
+    const RealVectorType& getEntropy(void) const;
+    /** Returns the average number of particles. Requires the conservation of charge. */
+    const RealVectorType& getOccupancy(void) const;
+    /** Returns the charge susceptibility. Requires the conservation of charge. */
+    const RealVectorType& getChargeSusceptibility(void) const;
+    /** Returns the spin susceptibility. Requires the conservation of the projection of spin. */
+    const RealVectorType& getSpinSusceptibility(void) const;
+};
+
+} // end of namespace Pomerol
+#endif // endif :: #ifndef __INCLUDE_THERMODYNAMICS_H
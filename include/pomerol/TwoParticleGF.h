@@ -59,6 +59,9 @@ protected:
     /** A flag to determine whether this GF is identical to zero */
     bool Vanishing;
 
+    /** The left and right blocks of the creation operator parts, which are used by the parts. */
+    BlockMappingSet NeededParts;
+
     /** Extracts a part of the operator standing at a specified position in a given permutation.
      * \param[in] PermutationNumber The number of the permutation.
      * \param[in] OperatorPosition The number of the position of the operator.
@@ -141,6 +144,10 @@ public:
     /** Returns true, if GF is identical to zero */
     bool isVanishing(void) const;
 
+    /** Returns the left and right blocks of the parts of the creation operators, which are used by the parts, 
+     * see FieldOperatorContainer::computeAll. Available after prepare(), the operators have to be prepared only. */
+    const BlockMappingSet& getNeededParts(void) const;
+
     /** Returns the number of current permutation in permutations3 */
     unsigned short getPermutationNumber(const Permutation3& in);
 };
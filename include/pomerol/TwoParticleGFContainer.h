@@ -63,6 +63,9 @@ public:
         const boost::mpi::communicator & comm = boost::mpi::communicator()
         );
 
+    /** Returns the parts of the creation operators, which are used by all prepared two-particle GFs, see FieldOperatorContainer::computeAll. */
+    BlockMappingSet getNeededParts() const;
+
 protected:
 
     friend class IndexContainer4<TwoParticleGF,TwoParticleGFContainer>;
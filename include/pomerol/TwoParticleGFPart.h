@@ -285,6 +285,18 @@ private:
                       RealType Ei, RealType Ej, RealType Ek, RealType El,
                       RealType Wi, RealType Wj, RealType Wk, RealType Wl);
 
+    /** Iterates over the chains \f$ \langle a|A|b\rangle\langle b|B|c\rangle\langle c|C|d\rangle\langle d|D|a\rangle \f$ and adds their multiterms.
+     * It is the chain \f$ \langle 1|O_1|2\rangle\langle 2|O_2|3\rangle\langle 3|O_3|4\rangle\langle 4|CX_4|1\rangle \f$ rotated by Shift operators.
+     * The outer loops run over all states a with all states c, if a is retained by the density matrix, or with the retained states c otherwise.
+     * The rotated chain (Shift == 1) skips the retained states b and d, such chains are found without the rotation.
+     * \param[in] A The row-major elements of the first operator of the chain.
+     * \param[in] B The column-major elements of the second operator of the chain.
+     * \param[in] C The row-major elements of the third operator of the chain.
+     * \param[in] D The column-major elements of the fourth operator of the chain.
+     * \param[in] Shift The rotation of the chain, 0 or 1.
+     */
+    void computeChains(const RowMajorView& A, const ColMajorView& B, const RowMajorView& C, const ColMajorView& D, int Shift);
+
     /** A difference in energies with magnitude less than this value is treated as zero. default = 1e-8. */
     RealType ReduceResonanceTolerance;
     /** Minimal magnitude of the coefficient of a term to take it into account. default = 1e-16. */
@@ -316,7 +328,9 @@ public:
                       const DensityMatrixPart& DMpart3, const DensityMatrixPart& DMpart4,
                 Permutation3 Permutation);
 
-    /** Actually computes the part. */
+    /** Actually computes the part. A chain of states contributes only if one of its states is retained by the density matrix,
+     * see DensityMatrixPart::getRetainedStates. The chains with the retained states |1> or |3> are found first, 
+     * the remaining ones are found in the chain rotated by one operator, which starts at |2>. */
     void compute();
 
     /** Purges all terms. */
@@ -251,26 +251,29 @@ int main(int argc, char* argv[])
         G.prepareAll(indices2); // identify all non-vanishing block connections in the Green's function
         G.computeAll(); // Evaluate all GF terms, i.e. resonances and weights of expressions in Lehmans representation of the Green's function
 
-        if (!comm.rank()) // dump gf into a file
-        // loops over all components (pairs of indices) of the Green's function
-        for (std::set<IndexCombination2>::const_iterator it = indices2.begin(); it != indices2.end(); ++it) {
-            IndexCombination2 ind2 = *it;
-            const GreensFunction & GF = G(ind2);
+        if (!comm.rank()) { // dump gf into a file
+        // all components (pairs of indices) of the Green's function are evaluated on the grids at once
+        std::vector<IndexCombination2> components(indices2.begin(), indices2.end());
+        fmatsubara_grid imfreq_grid(wf_min, wf_max*4, beta);
+        ComplexMatrixType gw_imfreq_values = G.evaluate(FermionicMatsubaraGrid(beta, wf_min, wf_max*4), components);
+        real_grid freq_grid(-hbw, hbw, 2*hbw/step+1, true);
+        ComplexMatrixType gw_refreq_values = G.evaluate(RealFrequencyGrid(-hbw, hbw, freq_grid.size(), eta), components);
+        for (size_t c = 0; c < components.size(); ++c) {
+            IndexCombination2 ind2 = components[c];
 
             mpi_cout << "Saving imfreq G" << ind2 << " on "<< 4*wf_max << " Matsubara freqs. " << std::endl;
-            grid_object<std::complex<double>, fmatsubara_grid> gf_imfreq (fmatsubara_grid(wf_min, wf_max*4, beta));
+            grid_object<std::complex<double>, fmatsubara_grid> gf_imfreq (imfreq_grid);
             std::string ind_str = boost::lexical_cast<std::string>(ind2.Index1)+ boost::lexical_cast<std::string>(ind2.Index2);
-            for (auto p : gf_imfreq.grid().points()) { gf_imfreq[p] = GF(p.value()); }
+            long n = 0;
+            for (auto p : gf_imfreq.grid().points()) { gf_imfreq[p] = gw_imfreq_values(c, n++); }
             gf_imfreq.savetxt("gw_imfreq_"+ ind_str +".dat");
 
-            real_grid freq_grid(-hbw, hbw, 2*hbw/step+1, true);
             grid_object<std::complex<double>, real_grid> gf_refreq(freq_grid);
-            for (auto p : freq_grid.points()) {
-                ComplexType val = GF(ComplexType(p.value()) + I*eta);
-                gf_refreq[p] = val;
-            };
+            long k = 0;
+            for (auto p : freq_grid.points()) { gf_refreq[p] = gw_refreq_values(c, k++); }
             gf_refreq.savetxt("gw_refreq_"+ ind_str +".dat");
         }
+        }
 
         // Start Two-particle GF calculation
 
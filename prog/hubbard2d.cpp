@@ -225,27 +225,35 @@ int main(int argc, char* argv[])
         G.prepareAll(indices2); // identify all non-vanishing block connections in the Green's function
         G.computeAll(); // Evaluate all GF terms, i.e. resonances and weights of expressions in Lehmans representation of the Green's function
 
-        if (!comm.rank()) // dump gf into a file
-        for (auto ind2 : indices2) { // loops over all components (pairs of indices) of the Green's function
+        if (!comm.rank()) { // dump gf into a file
+        // all components (pairs of indices) of the Green's function are evaluated on the grids at once
+        std::vector<IndexCombination2> components(indices2.begin(), indices2.end());
+        FermionicMatsubaraGrid imfreq_grid(beta, 0, wf_max*4);
+        ComplexMatrixType gw_imag_values = G.evaluate(imfreq_grid, components);
+        double e0 = U - 2.*mu;
+        long n_real = 2*hbw/step + 1;
+        RealFrequencyGrid refreq_grid(e0-hbw, e0+hbw, n_real, eta);
+        ComplexMatrixType gw_real_values = G.evaluate(refreq_grid, components);
+        for (size_t c = 0; c < components.size(); ++c) {
+            IndexCombination2 ind2 = components[c];
             // Save Matsubara GF from pi/beta to pi/beta*(4*wf_max + 1)
             std::cout << "Saving imfreq G" << ind2 << " on "<< 4*wf_max << " Matsubara freqs. " << std::endl;
             std::ofstream gw_im("gw_imag"+std::to_string(ind2.Index1)+std::to_string(ind2.Index2)+".dat");
-            const GreensFunction & GF = G(ind2);
             for (int wn = 0; wn < wf_max*4; wn++) {
-                ComplexType val = GF(I*FMatsubara(wn,beta)); // this comes from Pomerol - see GreensFunction::operator()
+                ComplexType val = gw_imag_values(c, wn); // this comes from Pomerol - see GFContainer::evaluate
                 gw_im << std::scientific << std::setprecision(12) << FMatsubara(wn,beta) << "   " << real(val) << " " << imag(val) << std::endl;
             };
             gw_im.close();
             // Save Retarded GF on the real axis
-            double e0 = U - 2.*mu;
             std::ofstream gw_re("gw_real"+std::to_string(ind2.Index1)+std::to_string(ind2.Index2)+".dat");
             std::cout << "Saving real-freq GF " << ind2 << " in energy space [" << e0-hbw << ":" << e0+hbw << ":" << step << "] + I*" << eta << "." << std::endl;
-            for (double w = e0-hbw; w < e0+hbw; w+=step) {
-                ComplexType val = GF(ComplexType(w) + I*eta);
-                gw_re << std::scientific << std::setprecision(12) << w << "   " << real(val) << " " << imag(val) << std::endl;
+            for (long k = 0; k < n_real; k++) {
+                ComplexType val = gw_real_values(c, k);
+                gw_re << std::scientific << std::setprecision(12) << real(refreq_grid.getPoint(k)) << "   " << real(val) << " " << imag(val) << std::endl;
             };
             gw_re.close();
         }
+        }
 
         // Start Two-particle GF calculation
 
@@ -94,6 +94,7 @@ public:
 
     define<int>(p, "calc_gf", false, "Calculate Green's functions");
     define<int>(p, "calc_2pgf", false, "Calculate 2-particle Green's functions");
+    define<int>(p, "plan", false, "Only estimate the sizes, memory and cost of the calculation, save them to plan.json and exit");
     define<int>(p, "wf_min", -20, "Minimum fermionic Matsubara freq");
     define<int>(p, "wf_max", 20, "Maximum fermionic Matsubara freq (4x for GF)");
     define<int>(p, "wb_min", 0, "Minimum bosonic Matsubara freq");
@@ -22,6 +22,8 @@ void quantum_model::compute() {
   StatesClassification S(IndexInfo,Symm); // Introduce Fock space and classify states to blocks
   S.compute();
 
+  if (p["plan"].as<int>()) { plan(IndexInfo, S); return; }
+
   Hamiltonian H(IndexInfo, Storage, S); // Hamiltonian in the basis of Fock Space
   H.prepare(); // enter the Hamiltonian matrices
   H.compute(); // compute eigenvalues and eigenvectors
@@ -90,43 +92,53 @@ void quantum_model::compute() {
     G.prepareAll(indices2); // identify all non-vanishing block connections in the Green's function
     G.computeAll(); // Evaluate all GF terms, i.e. resonances and weights of expressions in Lehmans representation of the Green's function
 
-    if (!comm.rank()) // dump gf into a file
-      // loops over all components (pairs of indices) of the Green's function
-      for (std::set<IndexCombination2>::const_iterator it = indices2.begin(); it != indices2.end(); ++it) {
-        IndexCombination2 ind2 = *it;
-        const GreensFunction & GF = G(ind2);
+    if (!comm.rank()) { // dump gf into a file
+      // all components (pairs of indices) of the Green's function are evaluated on the grids at once, see GFContainer::evaluate
+      std::vector<IndexCombination2> components(indices2.begin(), indices2.end());
+#ifdef POMEROL_CXX11
+      fmatsubara_grid imfreq_grid(wf_min, wf_max*4, beta, true);
+      ComplexMatrixType gw_imfreq_values = G.evaluate(FermionicMatsubaraGrid(beta, wf_min, wf_min + imfreq_grid.size()), components);
+      real_grid freq_grid(-hbw, hbw, 2*hbw/step+1, true);
+      ComplexMatrixType gw_refreq_values = G.evaluate(RealFrequencyGrid(-hbw, hbw, freq_grid.size(), eta), components);
+#else
+      ComplexMatrixType gw_imag_values = G.evaluate(FermionicMatsubaraGrid(beta, 0, wf_max*4 + 1), components);
+      long n_real = 2*hbw/step + 1;
+      RealFrequencyGrid refreq_grid(_e0-hbw, _e0+hbw, n_real, eta);
+      ComplexMatrixType gw_real_values = G.evaluate(refreq_grid, components);
+#endif
+      for (size_t c = 0; c < components.size(); ++c) {
+        IndexCombination2 ind2 = components[c];
         // Save Matsubara GF from pi/beta to pi/beta*(4*wf_max + 1)
         std::cout << "Saving imfreq G" << ind2 << " on " << 4 * wf_max << " Matsubara freqs. " << std::endl;
 #ifdef POMEROL_CXX11
-        grid_object<std::complex<double>, fmatsubara_grid> gf_imfreq (fmatsubara_grid(wf_min, wf_max*4, beta, true));
+        grid_object<std::complex<double>, fmatsubara_grid> gf_imfreq (imfreq_grid);
         std::string ind_str = boost::lexical_cast<std::string>(ind2.Index1)+ boost::lexical_cast<std::string>(ind2.Index2);
-        for (auto p : gf_imfreq.grid().points()) { gf_imfreq[p] = GF(p.value()); }
+        long n = 0;
+        for (auto p : gf_imfreq.grid().points()) { gf_imfreq[p] = gw_imfreq_values(c, n++); }
         gf_imfreq.savetxt("gw_imfreq_"+ ind_str +".dat");
 
-        real_grid freq_grid(-hbw, hbw, 2*hbw/step+1, true);
         grid_object<std::complex<double>, real_grid> gf_refreq(freq_grid);
-        for (auto p : freq_grid.points()) {
-          ComplexType val = GF(ComplexType(p.value()) + I*eta);
-          gf_refreq[p] = val;
-        };
+        long k = 0;
+        for (auto p : freq_grid.points()) { gf_refreq[p] = gw_refreq_values(c, k++); }
         gf_refreq.savetxt("gw_refreq_"+ ind_str +".dat");
 #else
         std::ofstream gw_im(("gw_imag" + boost::lexical_cast< std::string>(ind2.Index1) + boost::lexical_cast< std::string>(ind2.Index2) + ".dat").c_str());
         for (int wn = 0; wn <= wf_max*4; wn++) {
-          ComplexType val = GF(I*FMatsubara(wn,beta)); // this comes from Pomerol - see GreensFunction::operator()
+          ComplexType val = gw_imag_values(c, wn); // this comes from Pomerol - see GFContainer::evaluate
           gw_im << std::scientific << std::setprecision(12) << FMatsubara(wn, beta) << "   " << real(val) << " " << imag(val) << std::endl;
         };
         gw_im.close();
         // Save Retarded GF on the real axis
         std::ofstream gw_re(("gw_real" + boost::lexical_cast< std::string>(ind2.Index1) + boost::lexical_cast< std::string>(ind2.Index2) + ".dat").c_str());
         std::cout << "Saving real-freq GF " << ind2 << " in energy space [" << _e0 - hbw << ":" << _e0 + hbw << ":" << step << "] + I*" << eta << "." << std::endl;
-        for (double w = _e0-hbw; w < _e0+hbw; w+=step) {
-          ComplexType val = GF(ComplexType(w) + I*eta);
-          gw_re << std::scientific << std::setprecision(12) << w << "   " << real(val) << " " << imag(val) << std::endl;
+        for (long k = 0; k < n_real; k++) {
+          ComplexType val = gw_real_values(c, k);
+          gw_re << std::scientific << std::setprecision(12) << real(refreq_grid.getPoint(k)) << "   " << real(val) << " " << imag(val) << std::endl;
         };
         gw_re.close();
 #endif
       }
+    }
 
     // Start Two-particle GF calculation
 
@@ -255,3 +267,31 @@ void quantum_model::compute() {
     }
   }
 }
+
+void quantum_model::plan(const IndexClassification &IndexInfo, const StatesClassification &S) {
+  std::set<ParticleIndex> f;
+  std::set<IndexCombination2> indices2;
+  std::set<IndexCombination4> indices4;
+  if (calc_gf) {
+    std::pair<ParticleIndex, ParticleIndex> pair = get_node(IndexInfo);
+    f.insert(pair.first);
+    f.insert(pair.second);
+    prepare_indices(pair.first, pair.second, indices2, f, IndexInfo);
+  }
+  if (calc_2pgf) {
+    std::vector<size_t> indices_2pgf = p["2pgf.indices"].as< std::vector<size_t> >();
+    if (indices_2pgf.size() != 4) throw std::logic_error("Need 4 indices for 2pgf");
+    indices4.insert(IndexCombination4(indices_2pgf[0], indices_2pgf[1], indices_2pgf[2], indices_2pgf[3]));
+    for (size_t i=0; i<4; i++) f.insert(indices_2pgf[i]);
+  }
+
+  Planner Plan(IndexInfo, S); // Block sizes and the connections of blocks are enough for the estimates
+  Plan.compute(f, indices2, indices4);
+  if (!rank) {
+    print_section("Plan");
+    Plan.print(std::cout);
+    std::ofstream out("plan.json");
+    Plan.printJSON(out);
+    out.close();
+  }
+}
@@ -65,6 +65,9 @@ public:
 
   void compute();
 
+  /** Estimate the resources of the calculation without diagonalization. */
+  void plan(const IndexClassification &IndexInfo, const StatesClassification &S);
+
   virtual std::pair<ParticleIndex, ParticleIndex> get_node(const IndexClassification &IndexInfo) = 0;
 
   double FMatsubara(int n, double beta){return M_PI/beta*(2.*n+1);}
@@ -2,6 +2,43 @@
 
 namespace Pomerol{
 
+DiagonalObservable& DiagonalObservable::add(const std::vector<ParticleIndex>& Indices, RealType Coefficient)
+{
+    Terms.push_back(Term(Indices, Coefficient));
+    return *this;
+}
+
+DiagonalObservable& DiagonalObservable::operator+=(const DiagonalObservable& rhs)
+{
+    Terms.insert(Terms.end(), rhs.Terms.begin(), rhs.Terms.end());
+    return *this;
+}
+
+DiagonalObservable DiagonalObservable::Occupancy(ParticleIndex i)
+{
+    DiagonalObservable Out;
+    return Out.add(std::vector<ParticleIndex>(1, i));
+}
+
+DiagonalObservable DiagonalObservable::DoubleOccupancy(ParticleIndex i, ParticleIndex j)
+{
+    std::vector<ParticleIndex> Indices(1, i);
+    Indices.push_back(j);
+    DiagonalObservable Out;
+    return Out.add(Indices);
+}
+
+DiagonalObservable DiagonalObservable::SzSz(ParticleIndex UpA, ParticleIndex DownA, ParticleIndex UpB, ParticleIndex DownB)
+{
+    DiagonalObservable Out;
+    Out += DoubleOccupancy(UpA, UpB);
+    Out += DoubleOccupancy(DownA, DownB);
+    Out.add(DoubleOccupancy(UpA, DownB).Terms[0].first, -1.0);
+    Out.add(DoubleOccupancy(DownA, UpB).Terms[0].first, -1.0);
+    for (size_t t=0; t<Out.Terms.size(); t++) Out.Terms[t].second *= 0.25;
+    return Out;
+}
+
 DensityMatrix::DensityMatrix(const StatesClassification& S, const Hamiltonian& H, RealType beta) : 
     Thermal(beta), ComputableObject(), S(S), H(H)
 {}
@@ -40,6 +77,16 @@ void DensityMatrix::compute(void)
     Status = Computed;
 }
 
+void DensityMatrix::update(void)
+{
+    if (Status < Prepared) throw (exStatusMismatch());
+    RealType GroundEnergy = H.getGroundEnergy();
+    for(std::vector<DensityMatrixPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
+        (*iter)->GroundEnergy = GroundEnergy;
+    Status = Prepared;
+    compute();
+}
+
 RealType DensityMatrix::getWeight(QuantumState state) const
 {
     if ( Status < Computed ) { ERROR("DensityMatrix is not computed yet."); throw (exStatusMismatch()); };
@@ -95,6 +142,67 @@ RealType DensityMatrix::getAverageDoubleOccupancy(ParticleIndex i, ParticleIndex
     return NN;
 };
 
+std::vector<RealType> DensityMatrix::getAverages(const std::vector<DiagonalObservable>& Observables) const
+{
+    if ( Status < Computed ) { ERROR("DensityMatrix is not computed yet."); throw (exStatusMismatch()); };
+    // The distinct products of all observables, each one is a mask of its indices
+    size_t IndexSize = S.getFockStates(BlockNumber(0))[0].size();
+    std::vector<FockState> Masks;
+    std::map<FockState, size_t> MaskNumbers;
+    std::vector<std::vector<std::pair<size_t, RealType> > > Coefficients(Observables.size());
+    for (size_t o=0; o<Observables.size(); o++)
+        for (std::vector<DiagonalObservable::Term>::const_iterator it = Observables[o].Terms.begin(); it != Observables[o].Terms.end(); it++) {
+            FockState Mask(IndexSize);
+            for (size_t i=0; i<it->first.size(); i++) Mask.set(it->first[i]);
+            std::map<FockState, size_t>::const_iterator found = MaskNumbers.find(Mask);
+            if (found == MaskNumbers.end()) {
+                found = MaskNumbers.insert(std::make_pair(Mask, Masks.size())).first;
+                Masks.push_back(Mask);
+                };
+            Coefficients[o].push_back(std::make_pair(found->second, it->second));
+            };
+
+    RealVectorType Products = RealVectorType::Zero(Masks.size());
+    for(std::vector<DensityMatrixPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Products += (*iter)->getAverageProducts(Masks);
+
+    std::vector<RealType> Averages(Observables.size(), 0.0);
+    for (size_t o=0; o<Observables.size(); o++)
+        for (size_t t=0; t<Coefficients[o].size(); t++) Averages[o] += Coefficients[o][t].second * Products(Coefficients[o][t].first);
+    return Averages;
+}
+
+MatrixType DensityMatrix::getOneBodyDensityMatrix(void) const
+{
+    if ( Status < Computed ) { ERROR("DensityMatrix is not computed yet."); throw (exStatusMismatch()); };
+    // <c^+_i c_j> is the overlap of c_i|s> and c_j|s>
+    ParticleIndex IndexSize = S.getFockStates(BlockNumber(0))[0].size();
+    std::vector<Operator> Operators;
+    for (ParticleIndex i=0; i<IndexSize; i++) Operators.push_back(OperatorPresets::c(i));
+
+    MatrixType Out = MatrixType::Zero(IndexSize, IndexSize);
+    for(std::vector<DensityMatrixPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Out += (*iter)->getOverlapAverages(Operators);
+    return Out;
+}
+
+MatrixType DensityMatrix::getTwoBodyDensityMatrix(const std::vector<IndexCombination2>& Pairs) const
+{
+    if ( Status < Computed ) { ERROR("DensityMatrix is not computed yet."); throw (exStatusMismatch()); };
+    // <c^+_i c^+_j c_l c_k> is the overlap of c_j c_i|s> and c_l c_k|s>
+    std::vector<Operator> Operators;
+    for (size_t p=0; p<Pairs.size(); p++) {
+        Operator Pair = OperatorPresets::c(Pairs[p].Index2);
+        Pair *= OperatorPresets::c(Pairs[p].Index1);
+        Operators.push_back(Pair);
+        };
+
+    MatrixType Out = MatrixType::Zero(Pairs.size(), Pairs.size());
+    for(std::vector<DensityMatrixPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        Out += (*iter)->getOverlapAverages(Operators);
+    return Out;
+}
+
 void DensityMatrix::truncateBlocks(RealType Tolerance, bool verbose)
 {
     for(std::vector<DensityMatrixPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
@@ -106,7 +214,7 @@ void DensityMatrix::truncateBlocks(RealType Tolerance, bool verbose)
         for(BlockNumber i=0; i<S.NumberOfBlocks(); i++)
             if(isRetained(i)){
                 ++n_blocks_retained;
-                n_states_retained += S.getBlockSize(i);
+                n_states_retained += parts[i]->getRetainedStates().size();
             }
         INFO("Number of blocks retained: " << n_blocks_retained);
         INFO("Number of states retained: " << n_states_retained);
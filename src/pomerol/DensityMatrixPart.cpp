@@ -2,8 +2,11 @@
 
 namespace Pomerol{
 DensityMatrixPart::DensityMatrixPart(const StatesClassification &S, const HamiltonianPart& hpart, RealType beta, RealType GroundEnergy) :
-    Thermal(beta), S(S), hpart(hpart), GroundEnergy(GroundEnergy), weights(hpart.getSize()), retained(true)
-{}
+    Thermal(beta), S(S), hpart(hpart), GroundEnergy(GroundEnergy), weights(hpart.getNumberOfEigenStates()), retained(hpart.getNumberOfEigenStates() > 0),
+    StateRetained(hpart.getNumberOfEigenStates(), true)
+{
+    for(InnerQuantumState s = 0; s < StateRetained.size(); ++s) RetainedStates.push_back(s);
+}
 
 RealType DensityMatrixPart::computeUnnormalized(void)
 {
@@ -38,49 +41,120 @@ RealType DensityMatrixPart::getAverageEnergy(void) const
     return E;
 };
 
+namespace {
+
+/** Returns the sum of Weights(s) |U(f,s)|^2 over the eigenstates s for every FockState f. */
+template <typename EigenvectorsType>
+RealVectorType sumWeights(const EigenvectorsType& U, const RealVectorType& Weights)
+{
+    return U.cwiseAbs2().template cast<RealType>() * Weights;
+}
+
+/** A nonzero matrix element <To|A|From> of an operator A between the FockStates of two blocks. */
+struct Image {
+    InnerQuantumState From, To;
+    MelemType Value;
+    Image(InnerQuantumState From, InnerQuantumState To, MelemType Value):From(From),To(To),Value(Value){};
+};
+
+} // end of anonymous namespace
+
+RealVectorType DensityMatrixPart::getFockStateWeights(void) const
+{
+    #ifdef POMEROL_FLOAT_STORAGE
+    if (hpart.isCompressed()) return sumWeights(hpart.getCompressedMatrix(), weights);
+    #endif
+    return sumWeights(hpart.getMatrix(), weights);
+}
+
+RealType DensityMatrixPart::getAverageDiagonal(const RealVectorType& Values) const
+{
+    return getFockStateWeights().dot(Values);
+}
+
+RealVectorType DensityMatrixPart::getAverageProducts(const std::vector<FockState>& Masks) const
+{
+    const std::vector<FockState>& States = S.getFockStates(hpart.getBlockNumber());
+    RealMatrixType Pattern(States.size(), Masks.size());
+    for (InnerQuantumState f=0; f < States.size(); ++f)
+        for (size_t k=0; k < Masks.size(); ++k) Pattern(f,k) = Masks[k].is_subset_of(States[f]);
+    return Pattern.transpose() * getFockStateWeights();
+}
+
+MatrixType DensityMatrixPart::getOverlapAverages(const std::vector<Operator>& Operators) const
+{
+    size_t Size = Operators.size();
+    MatrixType Out = MatrixType::Zero(Size, Size);
+    InnerQuantumState NumberOfStates = weights.size();
+    if (NumberOfStates == 0) return Out;
+
+    // The images of the FockStates of the part, grouped by the blocks they belong to.
+    const std::vector<FockState>& States = S.getFockStates(hpart.getBlockNumber());
+    std::vector<std::vector<Image> > Images(Size);
+    std::map<BlockNumber, std::vector<size_t> > Groups;
+    for (size_t p=0; p<Size; p++) {
+        BlockNumber Target = ERROR_BLOCK_NUMBER;
+        for (InnerQuantumState f=0; f<States.size(); f++) {
+            std::map<FockState, MelemType> Result = Operators[p].actRight(States[f]);
+            for (std::map<FockState, MelemType>::const_iterator it = Result.begin(); it != Result.end(); it++) {
+                if ( it->first==ERROR_FOCK_STATE || std::abs(it->second)<=std::numeric_limits<RealType>::epsilon() ) continue;
+                if ( Target == ERROR_BLOCK_NUMBER ) Target = S.getBlockNumber(it->first);
+                else if ( S.getBlockNumber(it->first) != Target ) 
+                    throw (std::logic_error("DensityMatrixPart : the operator maps a block to several blocks."));
+                Images[p].push_back(Image(f, S.getInnerState(it->first), it->second));
+                }
+            }
+        if (Target != ERROR_BLOCK_NUMBER) Groups[Target].push_back(p);
+        }
+
+    RealVectorType SqrtWeights = weights.cwiseSqrt();
+    const InnerQuantumState PanelElements = 1 << 20;
+    for (std::map<BlockNumber, std::vector<size_t> >::const_iterator g = Groups.begin(); g != Groups.end(); g++) {
+        const std::vector<size_t>& Members = g->second;
+        InnerQuantumState TargetSize = S.getFockStates(g->first).size();
+        InnerQuantumState PanelStates = std::max(InnerQuantumState(1), PanelElements / InnerQuantumState(TargetSize * Members.size()));
+        ColMajorDenseMatrixType Panel;
+        for (InnerQuantumState s0=0; s0<NumberOfStates; s0+=PanelStates) {
+            InnerQuantumState Count = std::min(PanelStates, NumberOfStates - s0);
+            // The column m holds the weighted images A_m |s> of the eigenstates s of the panel, one after another.
+            Panel.setZero(TargetSize * Count, Members.size());
+            for (size_t m=0; m<Members.size(); m++)
+                for (InnerQuantumState s=0; s<Count; s++)
+                    for (std::vector<Image>::const_iterator it = Images[Members[m]].begin(); it != Images[Members[m]].end(); it++)
+                        Panel(s*TargetSize + it->To, m) += it->Value * SqrtWeights(s0+s) * hpart.getMatrixElement(it->From, s0+s);
+            ColMajorDenseMatrixType Overlaps = Panel.adjoint() * Panel;
+            for (size_t m=0; m<Members.size(); m++)
+                for (size_t n=0; n<Members.size(); n++) Out(Members[m], Members[n]) += Overlaps(m,n);
+            }
+        }
+    return Out;
+}
+
 RealType DensityMatrixPart::getAverageOccupancy(void) const
 {
-    RealType n=0.;
-    InnerQuantumState partSize = weights.size();
-    for(InnerQuantumState s = 0; s < partSize; ++s){
-        VectorType CurrentEigenState = hpart.getEigenState(s);
-        for (InnerQuantumState fi=0; (long) fi < CurrentEigenState.size(); ++fi)
-            n += weights(s)*
-		    S.getFockState(hpart.getBlockNumber(),fi).count()*
-		    std::abs(CurrentEigenState(fi)*CurrentEigenState(fi));
-    };
-    return n;
+    BlockNumber Block = hpart.getBlockNumber();
+    RealVectorType Values(hpart.getSize());
+    for (InnerQuantumState fi=0; fi < hpart.getSize(); ++fi) Values(fi) = S.getFockState(Block,fi).count();
+    return getAverageDiagonal(Values);
 };
 
 RealType DensityMatrixPart::getAverageOccupancy(ParticleIndex i) const
 {
-    RealType n=0.;
-    InnerQuantumState partSize = weights.size();
-    for(InnerQuantumState s = 0; s < partSize; ++s){
-        VectorType CurrentEigenState = hpart.getEigenState(s);
-        for (InnerQuantumState fi=0; (long) fi < CurrentEigenState.size(); ++fi)
-            n += weights(s)*
-		    S.getFockState(hpart.getBlockNumber(),fi).test(i)*
-		    std::abs(CurrentEigenState(fi)*CurrentEigenState(fi));
-    };
-    return n;
+    BlockNumber Block = hpart.getBlockNumber();
+    RealVectorType Values(hpart.getSize());
+    for (InnerQuantumState fi=0; fi < hpart.getSize(); ++fi) Values(fi) = S.getFockState(Block,fi).test(i);
+    return getAverageDiagonal(Values);
 };
 
-
-
 RealType DensityMatrixPart::getAverageDoubleOccupancy(ParticleIndex i, ParticleIndex j) const
 {
-    RealType NN=0.;
-    QuantumState partSize = weights.size();
-    for(InnerQuantumState s = 0; s < partSize; ++s){ // s is an EigenState number
-        VectorType CurrentEigenState = hpart.getEigenState(s);
-        for (InnerQuantumState fi=0; (long) fi < CurrentEigenState.size(); ++fi)
-            NN += weights(s)*
-		    S.getFockState(hpart.getBlockNumber(),fi)[i]*
-		    S.getFockState(hpart.getBlockNumber(),fi)[j]*
-		std::abs(CurrentEigenState(fi)*CurrentEigenState(fi));
-    }
-    return NN;
+    BlockNumber Block = hpart.getBlockNumber();
+    RealVectorType Values(hpart.getSize());
+    for (InnerQuantumState fi=0; fi < hpart.getSize(); ++fi) {
+        FockState state = S.getFockState(Block,fi);
+        Values(fi) = state[i]*state[j];
+        };
+    return getAverageDiagonal(Values);
 };
 
 RealType DensityMatrixPart::getWeight(InnerQuantumState s) const
@@ -90,13 +164,13 @@ RealType DensityMatrixPart::getWeight(InnerQuantumState s) const
 
 void DensityMatrixPart::truncate(RealType Tolerance)
 {
-    retained = false;
+    RetainedStates.clear();
     InnerQuantumState partSize = weights.size();
-    for(InnerQuantumState s = 0; s < partSize; ++s)
-        if ( weights(s) > Tolerance ){
-            retained = true;
-            break;
-        }
+    for(InnerQuantumState s = 0; s < partSize; ++s){
+        StateRetained[s] = ( weights(s) > Tolerance );
+        if (StateRetained[s]) RetainedStates.push_back(s);
+    }
+    retained = !RetainedStates.empty();
 }
 
 bool DensityMatrixPart::isRetained() const
@@ -104,4 +178,14 @@ bool DensityMatrixPart::isRetained() const
     return retained;
 }
 
+bool DensityMatrixPart::isRetained(InnerQuantumState s) const
+{
+    return StateRetained[s];
+}
+
+const std::vector<InnerQuantumState>& DensityMatrixPart::getRetainedStates() const
+{
+    return RetainedStates;
+}
+
 } // end of namespace Pomerol
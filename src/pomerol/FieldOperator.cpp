@@ -12,13 +12,28 @@ FieldOperator::FieldOperator(const IndexClassification &IndexInfo, const StatesC
 CreationOperator::CreationOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, ParticleIndex Index) :
     FieldOperator(IndexInfo,S,H,Index)
 {
-    O = new Pomerol::OperatorPresets::Cdag(Index);
+    O.reset(new Pomerol::OperatorPresets::Cdag(Index));
 }
 
 AnnihilationOperator::AnnihilationOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, ParticleIndex Index) :
     FieldOperator(IndexInfo,S,H,Index)
 {
-    O = new Pomerol::OperatorPresets::C(Index);
+    O.reset(new Pomerol::OperatorPresets::C(Index));
+}
+
+QuadraticOperator::QuadraticOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, 
+                                     ParticleIndex Index1, ParticleIndex Index2) :
+    FieldOperator(IndexInfo,S,H,Index1)
+{
+    Operator *CdagC = new Operator(Pomerol::OperatorPresets::c_dag(Index1));
+    (*CdagC) *= Pomerol::OperatorPresets::c(Index2);
+    O.reset(CdagC);
+}
+
+QuadraticOperator::QuadraticOperator(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, const Operator &O) :
+    FieldOperator(IndexInfo,S,H,0)
+{
+    this->O.reset(new Operator(O));
 }
 
 FieldOperator::BlocksBimap const& FieldOperator::getBlockMapping() const
@@ -62,44 +77,145 @@ void FieldOperator::compute(const boost::mpi::communicator& comm)
     if (Status >= Computed) return;
 
     if (!comm.rank()) INFO_NONEWLINE("Computing " << *O << " in eigenbasis of the Hamiltonian: ");
-/*
-
-    pMPI::mpi_skel<pMPI::ComputeWrap<FieldOperatorPart>> skel;
-    skel.parts.resize(parts.size());
-    for (size_t i=0; i<parts.size(); i++) { skel.parts[i] = pMPI::ComputeWrap<FieldOperatorPart>(*parts[i]);};
-    std::map<pMPI::JobId, pMPI::WorkerId> job_map = skel.run(comm, true); // actual running - very costly
+    std::vector<size_t> Order = getComputeOrder();
+    std::vector<FieldOperatorPart*> OrderedParts(Order.size());
+    for (size_t i = 0; i < Order.size(); i++) OrderedParts[i] = parts[Order[i]];
+    computeParts(OrderedParts, comm);
+    if (!comm.rank()) INFO(parts.size() << " parts.");
+    Status = Computed;
+}
 
+void FieldOperator::computeParts(const std::vector<FieldOperatorPart*>& Parts, const boost::mpi::communicator& comm)
+{
     int rank = comm.rank();
-    int comm_size = comm.size(); 
-
-    // Start distributing data
-    comm.barrier();
-         
-    for (size_t p = 0; p<parts.size(); p++) {
-
-        int nelem = 0;
-        if (rank == job_map[p]) nelem = parts[p]->elementsColMajor.nonZeros(); 
-        boost::mpi::broadcast(comm, nelem, job_map[p]);
-        auto data = parts[p]->elementsColMajor.data(); // Eigen::internal::CompressedStorage 
-        auto& value_start = data.value(0);
-        auto& index_start = data.index(0);
-        if (comm.rank()) parts[p]->elementsColMajor.resize(nelem);
-        exit(0);
-
-        //boost::mpi::broadcast(comm, parts[p]->elementsColMajor.data(), nelem, job_map[p]);
-        if (rank == job_map[p]) { 
-                parts[p]->Status = FieldOperatorPart::Computed;
-             };
+    int comm_size = comm.size();
+    size_t Size = Parts.size();
+
+    // Every rank finds the same owners : the most expensive parts are given to the least loaded ranks first.
+    std::vector<std::pair<RealType, size_t> > Costs(Size);
+    for (size_t p = 0; p < Size; p++)
+        Costs[p] = std::make_pair(-RealType(Parts[p]->HTo.getNumberOfEigenStates()) * Parts[p]->HFrom.getNumberOfEigenStates() * Parts[p]->HFrom.getSize(), p);
+    std::sort(Costs.begin(), Costs.end());
+    std::vector<int> Owners(Size);
+    std::vector<RealType> Load(comm_size, 0.0);
+    for (size_t i = 0; i < Size; i++) {
+        int owner = std::min_element(Load.begin(), Load.end()) - Load.begin();
+        Owners[Costs[i].second] = owner;
+        Load[owner] -= Costs[i].first;
+        };
+
+    std::vector<FieldOperatorPart*> Local;
+    for (size_t p = 0; p < Size; p++) if (Owners[p] == rank && Parts[p]->Status < FieldOperatorPart::Computed) Local.push_back(Parts[p]);
+    // The last position in Local, at which the eigenvectors of a block are used.
+    std::map<const HamiltonianPart*, long> LastUse;
+    for (size_t i = 0; i < Local.size(); i++) {
+        LastUse[&Local[i]->HFrom] = i;
+        LastUse[&Local[i]->HTo] = i;
+        };
+
+    long LocalSize = Local.size();
+    // An exception can't leave a parallel region, so it is passed on after the loop.
+    std::string Error;
+    #ifdef POMEROL_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,1)
+    #endif
+    for (long i = 0; i < LocalSize; i++) {
+        FieldOperatorPart &Part = *Local[i];
+        try { Part.compute(); }
+        catch (std::exception &e) {
+            #ifdef POMEROL_USE_OPENMP
+            #pragma omp critical
+            #endif
+            Error = e.what();
+            };
+        // Spilled eigenvectors, which are not needed anymore in this pass, are dropped from memory.
+        // A thread, which still reads them, gets them back from the scratch file.
+        if (LastUse.find(&Part.HFrom)->second == i) Part.HFrom.evict();
+        if (LastUse.find(&Part.HTo)->second == i) Part.HTo.evict();
+        };
+    if (!Error.empty()) throw (std::runtime_error("FieldOperator::computeParts : " + Error));
+
+    if (comm_size == 1) return;
+    // Distribute the compressed sparse rows : the row pointers, the column indices and the values are broadcast as plain arrays.
+    // The dense parts are broadcast as a single array of values.
+    for (size_t p = 0; p < Size; p++) {
+        FieldOperatorPart &Part = *Parts[p];
+        RowMajorMatrixType &M = Part.elementsRowMajor;
+        StorageColMajorDenseMatrixType &D = Part.elementsDense;
+        if (rank == Owners[p]) M.makeCompressed();
+        long Dims[4] = {Part.DenseStorage ? D.rows() : M.rows(), Part.DenseStorage ? D.cols() : M.cols(), M.nonZeros(), Part.DenseStorage};
+        boost::mpi::broadcast(comm, Dims, 4, Owners[p]);
+        if (Dims[3]) {
+            if (rank != Owners[p]) {
+                M = RowMajorMatrixType();
+                D.resize(Dims[0], Dims[1]);
+                };
+            boost::mpi::broadcast(comm, D.data(), Dims[0]*Dims[1], Owners[p]);
+            }
+        else {
+            if (rank != Owners[p]) {
+                D.resize(0,0);
+                M.resize(Dims[0], Dims[1]);
+                M.resizeNonZeros(Dims[2]);
+                };
+            boost::mpi::broadcast(comm, M.outerIndexPtr(), M.outerSize() + 1, Owners[p]);
+            boost::mpi::broadcast(comm, M.innerIndexPtr(), Dims[2], Owners[p]);
+            boost::mpi::broadcast(comm, M.valuePtr(), Dims[2], Owners[p]);
+            };
+        boost::mpi::broadcast(comm, Part.StorageError, Owners[p]);
+        if (rank != Owners[p]) {
+            Part.DenseStorage = Dims[3];
+            Part.elementsColMajor = M;
+            Part.AdjointOf = NULL;
+            Part.Status = FieldOperatorPart::Computed;
+            };
         };
-    comm.barrier();
-*/
-    size_t Size = parts.size();
-    for (size_t BlockIn = 0; BlockIn < Size; BlockIn++){
-        INFO_NONEWLINE( (int) ((1.0*BlockIn/Size) * 100 ) << "  " << std::flush);
-        parts[BlockIn]->compute();
-    };
-    INFO("");
-    Status = Computed;
+}
+
+std::vector<size_t> FieldOperator::getComputeOrder() const
+{
+    // The parts form chains of blocks, e.g. N -> N+1 -> N+2 for a creation operator.
+    // Following the chains, the left block of a part is the right block of the next one, 
+    // so the eigenvectors of every block are read only once per pass.
+    std::vector<size_t> Order;
+    Order.reserve(parts.size());
+    std::vector<bool> Done(parts.size(), false);
+    for (int pass = 0; pass < 2; pass++)
+        for (size_t p = 0; p < parts.size(); p++) {
+            // Start the chains at the parts, which are not continuations of others. The closed chains are left for the second pass.
+            if (Done[p] || (pass == 0 && mapPartsFromLeft.count(parts[p]->getRightIndex()))) continue;
+            for (size_t q = p; !Done[q]; ) {
+                Done[q] = true;
+                Order.push_back(q);
+                std::map<size_t,BlockNumber>::const_iterator next = mapPartsFromRight.find(parts[q]->getLeftIndex());
+                if (next == mapPartsFromRight.end()) break;
+                q = next->second;
+                }
+            }
+    return Order;
+}
+
+void FieldOperator::update(const boost::mpi::communicator& comm)
+{
+    if (Status < Prepared) throw (exStatusMismatch());
+    for (size_t p = 0; p < parts.size(); p++) parts[p]->setStatus(FieldOperatorPart::Prepared);
+    Status = Prepared;
+    compute(comm);
+}
+
+RealType FieldOperator::getStorageError(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    RealType Error = 0.0;
+    for (size_t p = 0; p < parts.size(); p++) Error = std::max(Error, parts[p]->getStorageError());
+    return Error;
+}
+
+size_t FieldOperator::getMemoryUsage(void) const
+{
+    size_t Bytes = 0;
+    for (size_t p = 0; p < parts.size(); p++) Bytes += parts[p]->getMemoryUsage();
+    return Bytes;
 }
 
 ParticleIndex FieldOperator::getIndex(void) const
@@ -148,6 +264,27 @@ void AnnihilationOperator::prepare()
     Status = Prepared;
 }
 
+void QuadraticOperator::prepare()
+{
+    if (Status >= Prepared) return;
+    size_t Size = parts.size();
+    for (BlockNumber RightIndex=0;RightIndex<S.NumberOfBlocks();RightIndex++){
+        BlockNumber LeftIndex = mapsTo(RightIndex);
+        if (LeftIndex.isCorrect()){
+            if (mapPartsFromLeft.count(LeftIndex)) throw (std::logic_error("QuadraticOperator : several blocks are mapped to a single block."));
+            FieldOperatorPart *Part = new QuadraticOperatorPart(IndexInfo, S,
+                                    H.getPart(RightIndex),H.getPart(LeftIndex), O);
+            parts.push_back(Part);
+            mapPartsFromRight[RightIndex]=Size;
+            mapPartsFromLeft[LeftIndex]=Size;
+            LeftRightBlocks.insert(BlockMapping(LeftIndex,RightIndex));
+            Size++;
+        }
+    }
+    INFO("QuadraticOperator: " << Size << " parts will be computed");
+    Status = Prepared;
+}
+
 BlockNumber FieldOperator::getRightIndex(BlockNumber LeftIndex) const
 {
     if (Status < Prepared) { ERROR("FieldOperator is not prepared yet."); throw (exStatusMismatch()); }
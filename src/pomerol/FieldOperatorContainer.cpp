@@ -3,48 +3,191 @@
 namespace Pomerol{
 
 FieldOperatorContainer::FieldOperatorContainer(IndexClassification &IndexInfo, StatesClassification &S, const Hamiltonian &H, bool use_transpose) : 
-    IndexInfo(IndexInfo), S(S), H(H), use_transpose(use_transpose)
+    IndexInfo(IndexInfo), S(S), H(H), use_transpose(use_transpose), AllParts(true), MemoryBudget(0), Clock(0)
 {}
 
+void FieldOperatorContainer::prepareIndex(ParticleIndex i) const
+{
+    if (mapCreationOperators.count(i)) return;
+    CreationOperator *CX = new CreationOperator(IndexInfo, S,H,i);
+    CX->prepare();
+    mapCreationOperators[i] = CX;
+    AnnihilationOperator *C = new AnnihilationOperator(IndexInfo, S,H,i);
+    C->prepare();
+    mapAnnihilationOperators[i] = C;
+}
+
 void FieldOperatorContainer::prepareAll(std::set<ParticleIndex> in)
 {
     if (in.size() == 0) for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); ++i) in.insert(i);
-    for (std::set<ParticleIndex>::const_iterator it = in.begin(); it!=in.end(); it++)
-        {
-            ParticleIndex i = *it;
-            CreationOperator *CX = new CreationOperator(IndexInfo, S,H,i);
-            CX->prepare();
-            mapCreationOperators[i] = CX;
-            AnnihilationOperator *C = new AnnihilationOperator(IndexInfo, S,H,i);
-            C->prepare();
-            mapAnnihilationOperators[i] = C;
-        }
+    for (std::set<ParticleIndex>::const_iterator it = in.begin(); it!=in.end(); it++) prepareIndex(*it);
 }
 
-void FieldOperatorContainer::computeAll()
+void FieldOperatorContainer::computeAll(const boost::mpi::communicator& comm)
 {
-    for (std::map <ParticleIndex, CreationOperator*>::iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) {
-        CreationOperator &cdag = *(cdag_it->second);
-        cdag.compute();
-        AnnihilationOperator &c = *mapAnnihilationOperators[cdag_it->first];
+    AllParts = true;
+    NeededParts.clear();
+    std::set<ParticleIndex> Indices;
+    for (std::map <ParticleIndex, CreationOperator*>::iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) 
+        Indices.insert(cdag_it->first);
+    computeParts(Indices, comm);
+}
+
+void FieldOperatorContainer::computeAll(const BlockMappingSet& Needed, const boost::mpi::communicator& comm)
+{
+    AllParts = false;
+    NeededParts = Needed;
+    std::set<ParticleIndex> Indices;
+    for (std::map <ParticleIndex, CreationOperator*>::iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) 
+        Indices.insert(cdag_it->first);
+    computeParts(Indices, comm);
+}
+
+void FieldOperatorContainer::computeParts(const std::set<ParticleIndex>& Indices, const boost::mpi::communicator& comm) const
+{
+    // The parts of all creation operators are distributed together, each operator is kept in its order of computation.
+    std::vector<FieldOperatorPart*> Parts;
+    for (std::set<ParticleIndex>::const_iterator it = Indices.begin(); it != Indices.end(); it++) {
+        CreationOperator &cdag = *mapCreationOperators[*it];
+        std::vector<size_t> Order = cdag.getComputeOrder();
+        for (size_t i = 0; i < Order.size(); i++) {
+            FieldOperatorPart *Part = cdag.parts[Order[i]];
+            if (Part->getStatus() >= FieldOperatorPart::Computed) continue;
+            if (AllParts || NeededParts.count(BlockMapping(Part->getLeftIndex(), Part->getRightIndex()))) Parts.push_back(Part);
+            };
+        };
+    if (!comm.rank()) INFO_NONEWLINE("Computing the creation operators in eigenbasis of the Hamiltonian: ");
+    FieldOperator::computeParts(Parts, comm);
+    if (!comm.rank()) INFO(Parts.size() << " parts.");
+
+    for (std::set<ParticleIndex>::const_iterator it = Indices.begin(); it != Indices.end(); it++) {
+        CreationOperator &cdag = *mapCreationOperators[*it];
+        cdag.Status = ComputableObject::Computed;
+        AnnihilationOperator &c = *mapAnnihilationOperators[*it];
 
         FieldOperator::BlocksBimap cdag_block_map = cdag.getBlockMapping();
-        // hack - copy transpose matrices into c
+        // The parts of c are not stored, they are adjoint views of the parts of cdag.
         for (FieldOperator::BlocksBimap::right_const_iterator cdag_map_it=cdag_block_map.right.begin(); cdag_map_it!=cdag_block_map.right.end(); cdag_map_it++) {
-                c.getPartFromRightIndex(cdag_map_it->second).elementsRowMajor = cdag.getPartFromRightIndex(cdag_map_it->first).getColMajorValue().adjoint();
-                c.getPartFromRightIndex(cdag_map_it->second).elementsColMajor = cdag.getPartFromRightIndex(cdag_map_it->first).getRowMajorValue().adjoint();
-                c.getPartFromRightIndex(cdag_map_it->second).Status = ComputableObject::Computed;
-                c.Status = ComputableObject::Computed;
+            FieldOperatorPart &Part = cdag.getPartFromRightIndex(cdag_map_it->first);
+            if (Part.getStatus() >= FieldOperatorPart::Computed) c.getPartFromRightIndex(cdag_map_it->second).setAdjointOf(Part);
             };
+        c.Status = ComputableObject::Computed;
+        };
+}
+
+void FieldOperatorContainer::updateAll(const boost::mpi::communicator& comm)
+{
+    // The evicted operators are left to acquire()
+    std::set<ParticleIndex> Indices;
+    for (std::map <ParticleIndex, CreationOperator*>::iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) {
+        CreationOperator &cdag = *(cdag_it->second);
+        if (cdag.Status >= ComputableObject::Computed) Indices.insert(cdag_it->first);
+        for (size_t p = 0; p < cdag.parts.size(); p++) cdag.parts[p]->setStatus(FieldOperatorPart::Prepared);
+        cdag.Status = ComputableObject::Prepared;
+        // c is filled from cdag in computeAll()
+        AnnihilationOperator &c = *mapAnnihilationOperators[cdag_it->first];
+        for (size_t p = 0; p < c.parts.size(); p++) c.parts[p]->setStatus(FieldOperatorPart::Prepared);
+        c.Status = ComputableObject::Prepared;
+        };
+    computeParts(Indices, comm);
+}
+
+BlockMappingSet FieldOperatorContainer::getRetainedParts(const DensityMatrix& DM) const
+{
+    BlockMappingSet Retained;
+    for (std::map <ParticleIndex, CreationOperator*>::const_iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) {
+        FieldOperator::BlocksBimap const& Blocks = cdag_it->second->getBlockMapping();
+        for (FieldOperator::BlocksBimap::left_const_iterator it = Blocks.left.begin(); it != Blocks.left.end(); it++)
+            if (DM.isRetained(it->first) || DM.isRetained(it->second)) Retained.insert(BlockMapping(it->first, it->second));
         };
+    return Retained;
+}
+
+std::set<BlockNumber> FieldOperatorContainer::getUnusedBlocks(const BlockMappingSet& Needed) const
+{
+    std::set<BlockNumber> Unused;
+    for (BlockNumber b = 0; b < S.NumberOfBlocks(); b++) Unused.insert(b);
+    for (BlockMappingSet::const_iterator it = Needed.begin(); it != Needed.end(); it++) {
+        Unused.erase(it->first);
+        Unused.erase(it->second);
+        };
+    return Unused;
+}
+
+void FieldOperatorContainer::setMemoryBudget(size_t Bytes)
+{
+    MemoryBudget = Bytes;
+    evict();
+}
+
+size_t FieldOperatorContainer::getMemoryUsage() const
+{
+    size_t Bytes = 0;
+    for (std::map <ParticleIndex, CreationOperator*>::const_iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) 
+        Bytes += cdag_it->second->getMemoryUsage() + mapAnnihilationOperators[cdag_it->first]->getMemoryUsage();
+    return Bytes;
+}
 
-// original
-    //for (auto c : mapAnnihilationOperators) c.second->compute();
+void FieldOperatorContainer::acquire(const std::set<ParticleIndex>& Indices, const boost::mpi::communicator& comm) const
+{
+    std::set<ParticleIndex> Missing;
+    for (std::set<ParticleIndex>::const_iterator it = Indices.begin(); it != Indices.end(); it++) {
+        prepareIndex(*it);
+        Uses[*it]++;
+        LastUse[*it] = ++Clock;
+        if (mapCreationOperators[*it]->Status < ComputableObject::Computed) Missing.insert(*it);
+        };
+    if (Missing.empty()) return;
+    // Make room for the new operators first
+    evict();
+    computeParts(Missing, comm);
+}
+
+void FieldOperatorContainer::release(const std::set<ParticleIndex>& Indices) const
+{
+    for (std::set<ParticleIndex>::const_iterator it = Indices.begin(); it != Indices.end(); it++) {
+        if (Uses[*it] > 0) Uses[*it]--;
+        if (ExpectedUses[*it] > 0) ExpectedUses[*it]--;
+        };
+    evict();
+}
+
+void FieldOperatorContainer::hint(const std::set<ParticleIndex>& Indices) const
+{
+    for (std::set<ParticleIndex>::const_iterator it = Indices.begin(); it != Indices.end(); it++) ExpectedUses[*it]++;
+}
+
+void FieldOperatorContainer::evict() const
+{
+    if (MemoryBudget == 0) return;
+    size_t Bytes = getMemoryUsage();
+    if (Bytes <= MemoryBudget) return;
+
+    // The candidates are sorted by the presence of announced uses and then by the time of the last use.
+    std::vector<std::pair<std::pair<bool, size_t>, ParticleIndex> > Candidates;
+    for (std::map <ParticleIndex, CreationOperator*>::const_iterator cdag_it = mapCreationOperators.begin(); cdag_it != mapCreationOperators.end(); ++cdag_it) {
+        ParticleIndex i = cdag_it->first;
+        if (cdag_it->second->Status < ComputableObject::Computed || Uses[i] > 0) continue;
+        Candidates.push_back(std::make_pair(std::make_pair(ExpectedUses[i] > 0, LastUse[i]), i));
+        };
+    std::sort(Candidates.begin(), Candidates.end());
+
+    for (size_t k = 0; k < Candidates.size() && Bytes > MemoryBudget; k++) {
+        CreationOperator &cdag = *mapCreationOperators[Candidates[k].second];
+        AnnihilationOperator &c = *mapAnnihilationOperators[Candidates[k].second];
+        Bytes -= cdag.getMemoryUsage() + c.getMemoryUsage();
+        // The parts of c are views of the parts of cdag, so both are released together.
+        for (size_t p = 0; p < c.parts.size(); p++) c.parts[p]->releaseElements();
+        for (size_t p = 0; p < cdag.parts.size(); p++) cdag.parts[p]->releaseElements();
+        c.Status = ComputableObject::Prepared;
+        cdag.Status = ComputableObject::Prepared;
+        };
 }
 
 const CreationOperator& FieldOperatorContainer::getCreationOperator(ParticleIndex in) const
 {
     if (IndexInfo.checkIndex(in)){
+        prepareIndex(in);
         return *mapCreationOperators[in];
         }
     else
@@ -54,6 +197,7 @@ const CreationOperator& FieldOperatorContainer::getCreationOperator(ParticleInde
 const AnnihilationOperator& FieldOperatorContainer::getAnnihilationOperator(ParticleIndex in) const
 {
     if (IndexInfo.checkIndex(in)){
+        prepareIndex(in);
         return *mapAnnihilationOperators[in];
         }
     else
@@ -4,76 +4,204 @@ using std::stringstream;
 
 namespace Pomerol{
 
+RealType FieldOperatorPart::DenseFillRatio = 0.5;
+
 FieldOperatorPart::FieldOperatorPart(
         const IndexClassification &IndexInfo, const StatesClassification &S, const HamiltonianPart &HFrom,  const HamiltonianPart &HTo, ParticleIndex PIndex) :
         ComputableObject(), IndexInfo(IndexInfo), S(S), HFrom(HFrom), HTo(HTo), PIndex(PIndex),
-        MatrixElementTolerance(1e-8)
+        DenseStorage(false), AdjointOf(NULL), MatrixElementTolerance(1e-8), StorageError(0.0)
 {}
 
+namespace {
+
+/** Conversion of the eigenvector components to the scalar type of the rotation. */
+template <typename Scalar> inline Scalar scalar_cast(const MelemType& x) { return x; }
+#ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+template <> inline RealType scalar_cast<RealType>(const MelemType& x) { return std::real(x); }
+#endif
+
+/** A nonzero matrix element <l|O|k> = value of the operator in the basis of FockStates. */
+struct Transition {
+    InnerQuantumState l, k;
+    MelemType value;
+    Transition(InnerQuantumState l, InnerQuantumState k, MelemType value):l(l),k(k),value(value){};
+};
+
+/** Copy the rows of the eigenvectors of H, which belong to the given FockStates, into the rows of Out. 
+ * The rows of the right hand side are multiplied by the matrix elements. */
+template <typename ScalarMatrixType>
+void gatherRows(const HamiltonianPart &H, const std::vector<Transition> &Transitions, bool Left, ScalarMatrixType &Out)
+{
+    typedef typename ScalarMatrixType::Scalar Scalar;
+    InnerQuantumState Size = H.getNumberOfEigenStates();
+    Out.resize(Transitions.size(), Size);
+    // The eigenvectors are stored in the columns, so the columns are the outer loop.
+    for (InnerQuantumState n=0; n<Size; n++)
+        for (size_t t=0; t<Transitions.size(); t++)
+            Out(t,n) = (Left ? scalar_cast<Scalar>(H.getMatrixElement(Transitions[t].l,n)) 
+                             : scalar_cast<Scalar>(Transitions[t].value) * scalar_cast<Scalar>(H.getMatrixElement(Transitions[t].k,n)));
+}
+
+/** Calculates U^{+}_{to} O U_{from} in the arithmetic of a given Scalar type and stores the elements larger than Tolerance.
+ * O is a sparse matrix in the basis of FockStates, so only the rows of U_{to} and U_{from} of the FockStates connected by O 
+ * are gathered and the rotation is a single product of the gathered rows. 
+ * The product is evaluated in panels of rows, which are thresholded on the fly, so the dense result is never stored at once.
+ * Returns the largest deviation of the stored elements from the ones calculated in Scalar. */
+template <typename Scalar>
+RealType rotate(const std::vector<Transition> &Transitions, const HamiltonianPart &HFrom, const HamiltonianPart &HTo, 
+                RealType Tolerance, RowMajorMatrixType &Elements)
+{
+    typedef Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic,Eigen::AutoAlign|Eigen::ColMajor> ScalarMatrixType;
+    // The eigenbasis may be truncated by HamiltonianPart::reduce, while the FockState basis is always full.
+    InnerQuantumState toSize = HTo.getNumberOfEigenStates(), fromSize = HFrom.getNumberOfEigenStates();
+    Elements.resize(toSize, fromSize);
+    Elements.setZero();
+    if (Transitions.empty()) return 0.0;
+    ScalarMatrixType Left, Right;
+    gatherRows(HTo, Transitions, true, Left);
+    gatherRows(HFrom, Transitions, false, Right);
+
+    const InnerQuantumState PanelElements = 1 << 20;
+    InnerQuantumState PanelRows = std::max(InnerQuantumState(1), PanelElements / std::max(fromSize, InnerQuantumState(1)));
+    std::vector<Eigen::Triplet<StorageMelemType> > Triplets;
+    RealType Error = 0.0;
+    ScalarMatrixType Panel;
+    for (InnerQuantumState r0=0; r0<toSize; r0+=PanelRows) {
+        InnerQuantumState Rows = std::min(PanelRows, toSize - r0);
+        Panel.noalias() = Left.middleCols(r0, Rows).adjoint() * Right;
+        for (InnerQuantumState m=0; m<fromSize; m++)
+            for (InnerQuantumState n=0; n<Rows; n++) {
+                if (!(std::abs(Panel(n,m)) > Tolerance)) continue;
+                StorageMelemType Value = StorageMelemType(Panel(n,m));
+                #ifdef POMEROL_FLOAT_STORAGE
+                Error = std::max(Error, RealType(std::abs(MelemType(Value) - MelemType(Panel(n,m)))));
+                #endif
+                Triplets.push_back(Eigen::Triplet<StorageMelemType>(r0+n, m, Value));
+                }
+        }
+    Elements.setFromTriplets(Triplets.begin(), Triplets.end());
+    return Error;
+}
+
+} // end of anonymous namespace
+
 void FieldOperatorPart::compute()
 {
     if ( Status >= Computed ) return;
-    BlockNumber to = HTo.getBlockNumber();
+    if ( !HFrom.hasEigenvectors() || !HTo.hasEigenvectors() ) throw (std::logic_error("FieldOperatorPart : the eigenvectors of a block are released."));
+    AdjointOf = NULL;
     BlockNumber from = HFrom.getBlockNumber();
+    BlockNumber to = HTo.getBlockNumber();
 
-    const std::vector<FockState>& toStates = S.getFockStates(to);
     const std::vector<FockState>& fromStates = S.getFockStates(from);
 
-    MatrixType RightMat(fromStates.size(), fromStates.size());
-    MatrixType LeftMat(toStates.size(), fromStates.size());
-    RightMat.setZero();
-    LeftMat.setZero();
-
     /* Rotation is done in the following way:
      * C_{nm} = \sum_{lk} U^{+}_{nl} C_{lk} U_{km} = \sum_{lk} U^{*}_{ln}O_{lk}U_{km},
      * where the actual sum starts from k state. Big letters denote global states, smaller - InnerQuantumStates.
-     * We use the fact each column of O_{lk} has only one nonzero elements.
+     * We use the fact that O_{lk} is sparse : a field operator has only one nonzero element in each column.
      * */
+    std::vector<Transition> Transitions;
+    bool RealValued = true;
     for (std::vector<FockState>::const_iterator CurrentState = fromStates.begin();
                                                 CurrentState < fromStates.end(); CurrentState++) {
 	    FockState K=*CurrentState;
         std::map<FockState, MelemType> result1 = O->actRight(K);
-        if (result1.size()) {
-            FockState L=result1.begin()->first;
+        for (std::map<FockState, MelemType>::const_iterator it = result1.begin(); it != result1.end(); it++) {
+            FockState L=it->first;
+	        if ( L==ERROR_FOCK_STATE || std::abs(it->second)<=std::numeric_limits<RealType>::epsilon() ) continue;
+            if ( S.getBlockNumber(L) != to ) throw (std::logic_error("FieldOperatorPart : the operator maps a block to several blocks."));
+            Transitions.push_back(Transition(S.getInnerState(L), S.getInnerState(K), it->second));
             #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
-            int sign = int(std::real(result1.begin()->second));
-            #else
-            int sign = result1.begin()->second;
+            if ( std::imag(it->second) != 0 ) RealValued = false;
             #endif
-	        if ( L!=ERROR_FOCK_STATE && std::abs(sign)>std::numeric_limits<RealType>::epsilon() ) {
-		        InnerQuantumState l=S.getInnerState(L), k=S.getInnerState(K);
+        }
+    }
 
-                for (InnerQuantumState n=0; n<toStates.size(); n++) {
-#ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
-                    LeftMat(n,k) = std::conj(HTo.getMatrixElement(l,n));
-#else
-                    LeftMat(n,k) = HTo.getMatrixElement(l,n);
-#endif
-                }
+    // Between two real parts the rotation of a real operator is real. 
+    if (RealValued && HFrom.isReal() && HTo.isReal()) 
+        StorageError = rotate<RealType>(Transitions, HFrom, HTo, MatrixElementTolerance, elementsRowMajor);
+    else 
+        StorageError = rotate<MelemType>(Transitions, HFrom, HTo, MatrixElementTolerance, elementsRowMajor);
 
-                for (InnerQuantumState m=0; m<fromStates.size(); m++) {
-                    RightMat(k,m) = RealType(sign) * HFrom.getMatrixElement(k,m);
-                }
-	        }
+    // A nearly dense part is cheaper to store as a single dense matrix than as two sparse ones, 
+    // and the Green's functions are evaluated on it with contiguous loads.
+    DenseStorage = (elementsRowMajor.nonZeros() > 0 && 
+                    elementsRowMajor.nonZeros() > DenseFillRatio * RealType(elementsRowMajor.rows()) * RealType(elementsRowMajor.cols()));
+    if (DenseStorage) {
+        elementsDense = elementsRowMajor.toDense();
+        elementsRowMajor = RowMajorMatrixType();
+        elementsColMajor = ColMajorMatrixType();
         }
-    }
+    else {
+        elementsDense.resize(0,0);
+        elementsColMajor = elementsRowMajor;
+        };
+    Status = Computed;
+}
 
-    elementsRowMajor = (LeftMat * RightMat).sparseView(MatrixElementTolerance);
-    #ifndef POMEROL_COMPLEX_MATRIX_ELEMENTS
-    elementsRowMajor.prune(MatrixElementTolerance);
-    #endif
-    elementsColMajor = elementsRowMajor;
+void FieldOperatorPart::setAdjointOf(const FieldOperatorPart &Part)
+{
+    if (Part.Status < Computed) throw (exStatusMismatch());
+    if (Part.AdjointOf) throw (std::logic_error("FieldOperatorPart : the adjoint of a view can not be viewed."));
+    elementsRowMajor = RowMajorMatrixType();
+    elementsColMajor = ColMajorMatrixType();
+    elementsDense.resize(0,0);
+    DenseStorage = false;
+    AdjointOf = &Part;
+    StorageError = Part.StorageError;
     Status = Computed;
 }
 
-const ColMajorMatrixType& FieldOperatorPart::getColMajorValue(void) const
+void FieldOperatorPart::releaseElements(void)
+{
+    elementsRowMajor = RowMajorMatrixType();
+    elementsColMajor = ColMajorMatrixType();
+    elementsDense.resize(0,0);
+    DenseStorage = false;
+    AdjointOf = NULL;
+    if (Status > Prepared) Status = Prepared;
+}
+
+size_t FieldOperatorPart::getMemoryUsage(void) const
+{
+    if (AdjointOf || Status < Computed) return 0;
+    if (DenseStorage) return elementsDense.size()*sizeof(StorageMelemType);
+    return (elementsRowMajor.nonZeros() + elementsColMajor.nonZeros())*(sizeof(StorageMelemType) + sizeof(int)) 
+           + (elementsRowMajor.outerSize() + elementsColMajor.outerSize() + 2)*sizeof(int);
+}
+
+// The row-major elements of an adjoint view are the column-major elements of AdjointOf and vice versa.
+ColMajorView FieldOperatorPart::getColMajorValue(void) const
 {
-    return elementsColMajor;
+    if (Status < Computed) throw (exStatusMismatch());
+    const FieldOperatorPart &Stored = (AdjointOf ? *AdjointOf : *this);
+    if (Stored.DenseStorage) return ColMajorView(Stored.elementsDense, AdjointOf != NULL);
+    if (AdjointOf) return ColMajorView(AdjointOf->elementsRowMajor, true);
+    return ColMajorView(elementsColMajor);
 }
 
-const RowMajorMatrixType& FieldOperatorPart::getRowMajorValue(void) const
+RowMajorView FieldOperatorPart::getRowMajorValue(void) const
 {
-    return elementsRowMajor;
+    if (Status < Computed) throw (exStatusMismatch());
+    const FieldOperatorPart &Stored = (AdjointOf ? *AdjointOf : *this);
+    if (Stored.DenseStorage) return RowMajorView(Stored.elementsDense, AdjointOf != NULL);
+    if (AdjointOf) return RowMajorView(AdjointOf->elementsColMajor, true);
+    return RowMajorView(elementsRowMajor);
+}
+
+bool FieldOperatorPart::isDense(void) const
+{
+    return (AdjointOf ? AdjointOf->DenseStorage : DenseStorage);
+}
+
+bool FieldOperatorPart::isAdjointView(void) const
+{
+    return AdjointOf != NULL;
+}
+
+RealType FieldOperatorPart::getStorageError(void) const
+{
+    return StorageError;
 }
 
 void FieldOperatorPart::print_to_screen() const  //print to screen C and CX
@@ -81,8 +209,9 @@ void FieldOperatorPart::print_to_screen() const  //print to screen C and CX
     BlockNumber to   = HTo.getBlockNumber();
     BlockNumber from = HFrom.getBlockNumber();
     INFO(S.getQuantumNumbers(from) << "->" << S.getQuantumNumbers(to));
-    for (size_t P=0; P<elementsColMajor.outerSize(); ++P)
-	for (ColMajorMatrixType::InnerIterator it(elementsColMajor,P); it; ++it) {
+    ColMajorView Elements = getColMajorValue();
+    for (ColMajorView::Index P=0; P<Elements.outerSize(); ++P)
+	for (ColMajorView::InnerIterator it(Elements,P); it; ++it) {
 	    FockState N = S.getFockState(to, it.row());
 	    FockState M = S.getFockState(from, it.col());
 	    INFO(N <<" " << M << " : " << it.value());
@@ -105,30 +234,35 @@ AnnihilationOperatorPart::AnnihilationOperatorPart(const IndexClassification &In
                                                   const HamiltonianPart &HFrom, const HamiltonianPart &HTo, ParticleIndex PIndex) :
     FieldOperatorPart(IndexInfo,S,HFrom,HTo,PIndex)
 {
-    O = new Pomerol::OperatorPresets::C(PIndex);
+    O.reset(new Pomerol::OperatorPresets::C(PIndex));
 }
 
 CreationOperatorPart::CreationOperatorPart(const IndexClassification &IndexInfo, const StatesClassification &S,
                                                   const HamiltonianPart &HFrom, const HamiltonianPart &HTo, ParticleIndex PIndex) :
     FieldOperatorPart(IndexInfo,S,HFrom,HTo,PIndex)
 {
-    O = new Pomerol::OperatorPresets::Cdag(PIndex);
+    O.reset(new Pomerol::OperatorPresets::Cdag(PIndex));
+}
+
+QuadraticOperatorPart::QuadraticOperatorPart(const IndexClassification &IndexInfo, const StatesClassification &S,
+                                             const HamiltonianPart &HFrom, const HamiltonianPart &HTo, boost::shared_ptr<const Operator> O) :
+    FieldOperatorPart(IndexInfo,S,HFrom,HTo,0) // the part is not labelled by a single index
+{
+    this->O = O;
 }
 
-const CreationOperatorPart& AnnihilationOperatorPart::transpose() const
+CreationOperatorPart AnnihilationOperatorPart::transpose() const
 {
-    CreationOperatorPart *CX = new CreationOperatorPart(IndexInfo, S, HTo, HFrom, PIndex); // swapped h_to and h_from
-    CX->elementsRowMajor = elementsRowMajor.transpose();
-    CX->elementsColMajor = elementsColMajor.transpose();
-    return *CX;
+    CreationOperatorPart CX(IndexInfo, S, HTo, HFrom, PIndex); // swapped h_to and h_from
+    CX.setAdjointOf(*this);
+    return CX;
 }
 
-const AnnihilationOperatorPart& CreationOperatorPart::transpose() const
+AnnihilationOperatorPart CreationOperatorPart::transpose() const
 {
-    AnnihilationOperatorPart *C = new AnnihilationOperatorPart(IndexInfo, S, HTo, HFrom, PIndex); // swapped h_to and h_from
-    C->elementsRowMajor = elementsRowMajor.transpose();
-    C->elementsColMajor = elementsColMajor.transpose();
-    return *C;
+    AnnihilationOperatorPart C(IndexInfo, S, HTo, HFrom, PIndex); // swapped h_to and h_from
+    C.setAdjointOf(*this);
+    return C;
 }
 
 } // end of namespace Pomerol
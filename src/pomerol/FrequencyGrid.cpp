@@ -0,0 +1,69 @@
+#include "pomerol/FrequencyGrid.h"
+
+namespace Pomerol{
+
+FrequencyGrid::FrequencyGrid()
+{}
+
+FrequencyGrid::FrequencyGrid(const ComplexVectorType& Points)
+{
+    setPoints(Points);
+}
+
+void FrequencyGrid::setPoints(const ComplexVectorType& Points)
+{
+    this->Points = Points;
+    // The Matsubara frequencies with the numbers n and -n-1 (-n for the bosonic ones) are exact negatives of each other,
+    // so the conjugates are found by an exact match.
+    std::map<std::pair<RealType, RealType>, long> Positions;
+    for (long n = 0; n < Points.size(); n++) Positions[std::make_pair(real(Points(n)), imag(Points(n)))] = n;
+    Conjugates.assign(Points.size(), -1);
+    for (long n = 0; n < Points.size(); n++) {
+        std::map<std::pair<RealType, RealType>, long>::const_iterator it = Positions.find(std::make_pair(real(Points(n)), -imag(Points(n))));
+        if (it != Positions.end()) Conjugates[n] = it->second;
+        };
+}
+
+long FrequencyGrid::size() const
+{
+    return Points.size();
+}
+
+const ComplexVectorType& FrequencyGrid::getPoints() const
+{
+    return Points;
+}
+
+ComplexType FrequencyGrid::getPoint(long n) const
+{
+    return Points(n);
+}
+
+long FrequencyGrid::getConjugate(long n) const
+{
+    return Conjugates[n];
+}
+
+FermionicMatsubaraGrid::FermionicMatsubaraGrid(RealType beta, long MinNumber, long MaxNumber)
+{
+    ComplexVectorType Points(std::max(MaxNumber - MinNumber, 0L));
+    for (long n = MinNumber; n < MaxNumber; n++) Points(n - MinNumber) = ComplexType(0, M_PI/beta*RealType(2*n+1));
+    setPoints(Points);
+}
+
+BosonicMatsubaraGrid::BosonicMatsubaraGrid(RealType beta, long MinNumber, long MaxNumber)
+{
+    ComplexVectorType Points(std::max(MaxNumber - MinNumber, 0L));
+    for (long n = MinNumber; n < MaxNumber; n++) Points(n - MinNumber) = ComplexType(0, M_PI/beta*RealType(2*n));
+    setPoints(Points);
+}
+
+RealFrequencyGrid::RealFrequencyGrid(RealType Min, RealType Max, long NumberOfPoints, RealType Broadening)
+{
+    ComplexVectorType Points(std::max(NumberOfPoints, 0L));
+    for (long k = 0; k < NumberOfPoints; k++)
+        Points(k) = ComplexType(NumberOfPoints > 1 ? Min + (Max - Min)*k/(NumberOfPoints - 1) : Min, Broadening);
+    setPoints(Points);
+}
+
+} // end of namespace Pomerol
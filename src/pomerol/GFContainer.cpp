@@ -10,19 +10,151 @@ GFContainer::GFContainer ( const IndexClassification& IndexInfo,
     Thermal(DM), S(S), H(H), DM(DM), Operators(Operators)
 {}
 
+GFContainer::GFContainer(const GFContainer& G, const DensityMatrix &DM) :
+    IndexContainer2<GreensFunction,GFContainer>(this,G.IndexInfo),
+    Thermal(DM), S(G.S), H(G.H), DM(DM), Operators(G.Operators)
+{
+    for(std::map<IndexCombination2,GFPointer>::const_iterator iter = G.ElementsMap.begin();
+        iter != G.ElementsMap.end(); iter++)
+        ElementsMap[iter->first] = GFPointer(new GreensFunction(*iter->second, DM));
+}
+
+namespace {
+
+/** The indices of the operators of a Green's function. */
+std::set<ParticleIndex> getOperatorIndices(const GreensFunction& GF)
+{
+    std::set<ParticleIndex> Indices;
+    Indices.insert(GF.getIndex(0));
+    Indices.insert(GF.getIndex(1));
+    return Indices;
+}
+
+} // end of anonymous namespace
+
 void GFContainer::prepareAll(const std::set<IndexCombination2>& InitialIndices)
 {
     fill(InitialIndices);
     for(std::map<IndexCombination2,GFPointer>::iterator iter = ElementsMap.begin();
-        iter != ElementsMap.end(); iter++)
+        iter != ElementsMap.end(); iter++) {
         (iter->second)->prepare();
+        Operators.hint(getOperatorIndices(*iter->second));
+        };
 }
 
-void GFContainer::computeAll()
+// The operators of each Green's function are acquired for its computation only, see FieldOperatorContainer::acquire.
+void GFContainer::computeAll(const boost::mpi::communicator& comm)
 {
+    std::vector<GreensFunction*> Elements;
     for(std::map<IndexCombination2,GFPointer>::iterator iter = ElementsMap.begin();
+        iter != ElementsMap.end(); iter++) {
+        (iter->second)->prepare();
+        if ((iter->second)->getStatus() < GreensFunction::Computed) Elements.push_back(iter->second.get());
+        };
+    if (Elements.empty()) return;
+
+    // A rank knows only the transitions of the parts, which it has computed, so all ranks agree to use the operators first.
+    std::vector<int> HasTransitions(Elements.size()), AllHaveTransitions(Elements.size());
+    for (size_t e = 0; e < Elements.size(); e++) HasTransitions[e] = Elements[e]->hasTransitions();
+    boost::mpi::all_reduce(comm, &HasTransitions[0], Elements.size(), &AllHaveTransitions[0], boost::mpi::minimum<int>());
+
+    std::vector<GreensFunctionPart*> Parts;
+    std::vector<GreensFunction*> Reweighted;
+    for (size_t e = 0; e < Elements.size(); e++) {
+        GreensFunction &GF = *Elements[e];
+        if (AllHaveTransitions[e]) {
+            Parts.insert(Parts.end(), GF.parts.begin(), GF.parts.end());
+            Reweighted.push_back(&GF);
+            continue;
+            };
+        std::set<ParticleIndex> Indices = getOperatorIndices(GF);
+        Operators.acquire(Indices, comm);
+        GF.compute(comm);
+        Operators.release(Indices);
+        };
+
+    GreensFunction::computeParts(Parts, comm);
+    for (size_t e = 0; e < Reweighted.size(); e++) {
+        Reweighted[e]->freeze();
+        Reweighted[e]->Status = GreensFunction::Computed;
+        };
+}
+
+void GFContainer::updateAll(const boost::mpi::communicator& comm)
+{
+    for(std::map<IndexCombination2,GFPointer>::iterator iter = ElementsMap.begin();
+        iter != ElementsMap.end(); iter++) {
+        std::set<ParticleIndex> Indices = getOperatorIndices(*iter->second);
+        Operators.acquire(Indices, comm);
+        (iter->second)->update(comm);
+        Operators.release(Indices);
+        };
+}
+
+BlockMappingSet GFContainer::getNeededParts() const
+{
+    BlockMappingSet Needed;
+    for(std::map<IndexCombination2,GFPointer>::const_iterator iter = ElementsMap.begin();
         iter != ElementsMap.end(); iter++)
-        (iter->second)->compute();
+        Needed.insert((iter->second)->getNeededParts().begin(), (iter->second)->getNeededParts().end());
+    return Needed;
+}
+
+ComplexMatrixType GFContainer::evaluate(const FrequencyGrid& Grid, const std::vector<IndexCombination2>& Indices)
+{
+    long NumberOfComponents = Indices.size(), NumberOfPoints = Grid.size();
+    std::vector<const GreensFunction*> Components(NumberOfComponents);
+    std::map<IndexCombination2, long> Positions;
+    for (long c = 0; c < NumberOfComponents; c++) {
+        GreensFunction &GF = (*this)(Indices[c]);
+        if (GF.getStatus() < GreensFunction::Computed) { ERROR("GFContainer::evaluate : G" << Indices[c] << " is not computed yet."); throw (GreensFunction::exStatusMismatch()); };
+        Components[c] = &GF;
+        Positions[Indices[c]] = c;
+        };
+
+    // The points below the real axis, whose conjugates are in the grid, are taken from the transposed components, if there are any.
+    std::vector<long> Transposed(NumberOfComponents, -1);
+    for (long c = 0; c < NumberOfComponents; c++) {
+        std::map<IndexCombination2, long>::const_iterator it = Positions.find(IndexCombination2(Indices[c].Index2, Indices[c].Index1));
+        if (it != Positions.end()) Transposed[c] = it->second;
+        };
+    std::vector<long> AllPoints, UpperPoints;
+    for (long n = 0; n < NumberOfPoints; n++) {
+        AllPoints.push_back(n);
+        if (Grid.getConjugate(n) < 0 || imag(Grid.getPoint(n)) >= 0) UpperPoints.push_back(n);
+        };
+
+    // A job is a block of points of a component, which are evaluated at once.
+    const long BlockSize = 256;
+    std::vector<std::pair<long, long> > Jobs;
+    for (long c = 0; c < NumberOfComponents; c++) {
+        long Size = (Transposed[c] < 0 ? AllPoints : UpperPoints).size();
+        for (long Start = 0; Start < Size; Start += BlockSize) Jobs.push_back(std::make_pair(c, Start));
+        };
+
+    ComplexMatrixType Values(NumberOfComponents, NumberOfPoints);
+    long NumberOfJobs = Jobs.size();
+    #ifdef POMEROL_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,1)
+    #endif
+    for (long j = 0; j < NumberOfJobs; j++) {
+        long c = Jobs[j].first, Start = Jobs[j].second;
+        const std::vector<long> &Points = Transposed[c] < 0 ? AllPoints : UpperPoints;
+        long Length = std::min(BlockSize, long(Points.size()) - Start);
+        ComplexVectorType z(Length);
+        for (long k = 0; k < Length; k++) z(k) = Grid.getPoint(Points[Start + k]);
+        ComplexVectorType BlockValues = (*Components[c])(z);
+        for (long k = 0; k < Length; k++) Values(c, Points[Start + k]) = BlockValues(k);
+        };
+
+    for (long c = 0; c < NumberOfComponents; c++) {
+        if (Transposed[c] < 0) continue;
+        for (long n = 0; n < NumberOfPoints; n++) {
+            long m = Grid.getConjugate(n);
+            if (m >= 0 && imag(Grid.getPoint(n)) < 0) Values(c, n) = conj(Values(Transposed[c], m));
+            };
+        };
+    return Values;
 }
 
 GreensFunction* GFContainer::createElement(const IndexCombination2& Indices) const
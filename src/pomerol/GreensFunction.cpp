@@ -10,12 +10,28 @@ GreensFunction::GreensFunction(const StatesClassification& S, const Hamiltonian&
 }
 
 GreensFunction::GreensFunction(const GreensFunction& GF) :
-    Thermal(GF.beta), ComputableObject(GF), S(GF.S), H(GF.H), C(GF.C), CX(GF.CX), DM(GF.DM), Vanishing(GF.Vanishing)
+    Thermal(GF.beta), ComputableObject(GF), S(GF.S), H(GF.H), C(GF.C), CX(GF.CX), DM(GF.DM), Vanishing(GF.Vanishing), NeededParts(GF.NeededParts),
+    Terms(GF.Terms)
 {
     for(std::list<GreensFunctionPart*>::const_iterator iter = GF.parts.begin(); iter != GF.parts.end(); iter++)
         parts.push_back(new GreensFunctionPart(**iter));
 }
 
+GreensFunction::GreensFunction(const GreensFunction& GF, const DensityMatrix& DM) :
+    Thermal(DM.beta), ComputableObject(), S(GF.S), H(GF.H), C(GF.C), CX(GF.CX), DM(DM), Vanishing(GF.Vanishing), NeededParts(GF.NeededParts)
+{
+    if(GF.Status<Prepared) throw (exStatusMismatch());
+    for(BlockNumber Block=0; Block<S.NumberOfBlocks(); Block++){
+        const std::vector<InnerQuantumState>& Retained = DM.getPart(Block).getRetainedStates();
+        for(size_t s=0; s<Retained.size(); s++)
+            if(!GF.DM.getPart(Block).isRetained(Retained[s]))
+                throw std::logic_error("GreensFunction : the density matrix retains a state, which is truncated for the parts.");
+    }
+    for(std::list<GreensFunctionPart*>::const_iterator iter = GF.parts.begin(); iter != GF.parts.end(); iter++)
+        parts.push_back(new GreensFunctionPart(**iter, DM));
+    Status = Prepared;
+}
+
 GreensFunction::~GreensFunction()
 {
     for(std::list<GreensFunctionPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
@@ -45,12 +61,15 @@ void GreensFunction::prepare(void)
         if(Cleft == CXright && Cright == CXleft){
         //DEBUG(S.getQuantumNumbers(Cleft) << "|" << S.getQuantumNumbers(Cright) << "||" << S.getQuantumNumbers(CXleft) << "|" << S.getQuantumNumbers(CXright) );
             // check if retained blocks are included. If not, do not push.
-            if ( DM.isRetained(Cleft) || DM.isRetained(Cright) )
+            if ( DM.isRetained(Cleft) || DM.isRetained(Cright) ) {
                 parts.push_back(new GreensFunctionPart(
                               (AnnihilationOperatorPart&)C.getPartFromLeftIndex(Cleft),
                               (CreationOperatorPart&)CX.getPartFromRightIndex(CXright),
                               H.getPart(Cright), H.getPart(Cleft),
                               DM.getPart(Cright), DM.getPart(Cleft)));
+                // The part of C is the adjoint of the creation operator part from Cleft to Cright.
+                NeededParts.insert(BlockMapping(CXleft, CXright));
+                };
         }
 
         unsigned long CleftInt = Cleft;
@@ -64,18 +83,109 @@ void GreensFunction::prepare(void)
     Status = Prepared;
 }
 
-void GreensFunction::compute()
+void GreensFunction::compute(const boost::mpi::communicator& comm)
 {
     if(Status>=Computed) return;
     if(Status<Prepared) prepare();
 
-    if(Status<Computed){
-        for(std::list<GreensFunctionPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
-            (*iter)->compute();
-    }
+    computeParts(std::vector<GreensFunctionPart*>(parts.begin(), parts.end()), comm);
+    freeze();
     Status = Computed;
 }
 
+void GreensFunction::freeze()
+{
+    typedef GreensFunctionPart::Term Term;
+    std::vector<TermArrays::Term> AllTerms;
+    for(std::list<GreensFunctionPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++){
+        std::set<Term, Term::Compare> const& PartTerms = (*iter)->Terms.as_set();
+        for(std::set<Term, Term::Compare>::const_iterator it = PartTerms.begin(); it != PartTerms.end(); ++it)
+            AllTerms.push_back(TermArrays::Term(it->Pole, it->Residue));
+    }
+    // The tolerance of the terms of the parts
+    Terms.assign(AllTerms, 1e-8);
+}
+
+void GreensFunction::computeParts(const std::vector<GreensFunctionPart*>& Parts, const boost::mpi::communicator& comm)
+{
+    int rank = comm.rank();
+    int comm_size = comm.size();
+    size_t Size = Parts.size();
+
+    // Every rank finds the same owners, see FieldOperator::computeParts. The cost of a part does not depend on
+    // its transitions, which are known only to the rank, which has computed them.
+    std::vector<std::pair<RealType, size_t> > Costs(Size);
+    for (size_t p = 0; p < Size; p++)
+        Costs[p] = std::make_pair(-RealType(Parts[p]->HpartInner.getNumberOfEigenStates()) * Parts[p]->HpartOuter.getNumberOfEigenStates(), p);
+    std::sort(Costs.begin(), Costs.end());
+    std::vector<int> Owners(Size);
+    std::vector<RealType> Load(comm_size, 0.0);
+    for (size_t i = 0; i < Size; i++) {
+        int owner = std::min_element(Load.begin(), Load.end()) - Load.begin();
+        Owners[Costs[i].second] = owner;
+        Load[owner] -= Costs[i].first;
+        };
+
+    // The largest parts go first, so the threads finish together.
+    std::vector<GreensFunctionPart*> Local;
+    for (size_t i = 0; i < Size; i++) if (Owners[Costs[i].second] == rank) Local.push_back(Parts[Costs[i].second]);
+
+    long LocalSize = Local.size();
+    // An exception can't leave a parallel region, so it is passed on after the loop.
+    std::string Error;
+    #ifdef POMEROL_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,1)
+    #endif
+    for (long i = 0; i < LocalSize; i++) {
+        try { Local[i]->compute(); }
+        catch (std::exception &e) {
+            #ifdef POMEROL_USE_OPENMP
+            #pragma omp critical
+            #endif
+            Error = e.what();
+            };
+        };
+    if (!Error.empty()) throw (std::runtime_error("GreensFunction::computeParts : " + Error));
+
+    if (comm_size == 1) return;
+    // Distribute the terms : the residues and the poles are broadcast as plain arrays.
+    // The terms of a part are not similar to each other, so the other ranks insert them as they are.
+    typedef GreensFunctionPart::Term Term;
+    std::vector<ComplexType> Residues;
+    std::vector<RealType> Poles;
+    for (size_t p = 0; p < Size; p++) {
+        TermList<Term> &Terms = Parts[p]->Terms;
+        long NumberOfTerms = Terms.size();
+        boost::mpi::broadcast(comm, NumberOfTerms, Owners[p]);
+        if (NumberOfTerms == 0) { Terms.clear(); continue; };
+        Residues.resize(NumberOfTerms);
+        Poles.resize(NumberOfTerms);
+        if (rank == Owners[p]) {
+            long t = 0;
+            for (std::set<Term, Term::Compare>::const_iterator it = Terms.as_set().begin(); it != Terms.as_set().end(); ++it, ++t) {
+                Residues[t] = it->Residue;
+                Poles[t] = it->Pole;
+                };
+            };
+        boost::mpi::broadcast(comm, &Residues[0], NumberOfTerms, Owners[p]);
+        boost::mpi::broadcast(comm, &Poles[0], NumberOfTerms, Owners[p]);
+        if (rank != Owners[p]) {
+            Terms.clear();
+            for (long t = 0; t < NumberOfTerms; t++) Terms.add_term(Term(Residues[t], Poles[t]));
+            };
+        };
+}
+
+void GreensFunction::update(const boost::mpi::communicator& comm)
+{
+    if(Status<Prepared) throw (exStatusMismatch());
+    Status = Prepared;
+    // The parts find their transitions again, the parts at other temperatures keep the old ones.
+    for(std::list<GreensFunctionPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
+        (*iter)->Transitions.reset();
+    compute(comm);
+}
+
 unsigned short GreensFunction::getIndex(size_t Position) const
 {
     switch(Position){
@@ -87,9 +197,22 @@ unsigned short GreensFunction::getIndex(size_t Position) const
     return C.getIndex();
 }
 
+const BlockMappingSet& GreensFunction::getNeededParts(void) const
+{
+    if (Status < Prepared) throw (exStatusMismatch());
+    return NeededParts;
+}
+
 bool GreensFunction::isVanishing(void) const
 {
     return Vanishing;
 }
 
+bool GreensFunction::hasTransitions(void) const
+{
+    for(std::list<GreensFunctionPart*>::const_iterator iter = parts.begin(); iter != parts.end(); iter++)
+        if(!(*iter)->hasTransitions()) return false;
+    return true;
+}
+
 } // end of namespace Pomerol
@@ -37,21 +37,69 @@ GreensFunctionPart::GreensFunctionPart( const AnnihilationOperatorPart& C, const
                                         ReduceTolerance(1e-8)
 {}
 
-void GreensFunctionPart::compute(void)
+GreensFunctionPart::GreensFunctionPart(const GreensFunctionPart& Part, const DensityMatrix& DM) :
+                                        Thermal(DM),
+                                        Terms(Term::Compare(1e-8), Term::IsNegligible(1e-8)),
+                                        HpartInner(Part.HpartInner), HpartOuter(Part.HpartOuter),
+                                        DMpartInner(DM.getPart(Part.HpartInner.getBlockNumber())),
+                                        DMpartOuter(DM.getPart(Part.HpartOuter.getBlockNumber())),
+                                        C(Part.C), CX(Part.CX),
+                                        Transitions(Part.Transitions),
+                                        MatrixElementTolerance(Part.MatrixElementTolerance),
+                                        ReduceResonanceTolerance(Part.ReduceResonanceTolerance),
+                                        ReduceTolerance(Part.ReduceTolerance)
+{}
+
+void GreensFunctionPart::addTransition(InnerQuantumState Outer, InnerQuantumState Inner, MelemType MatrixElement)
 {
-    Terms.clear();
+    // The residues are products of the matrix elements and the sums of two weights, which are at most 1,
+    // so the transitions with smaller matrix elements never make a relevant term.
+    if(abs(MatrixElement) > MatrixElementTolerance)
+        Transitions->push_back(Transition(Outer, Inner, MatrixElement, HpartInner.getEigenValue(Inner) - HpartOuter.getEigenValue(Outer)));
+}
+
+void GreensFunctionPart::computeTransitions(void)
+{
+    Transitions.reset(new std::vector<Transition>);
 
     // Blocks (submatrices) of C and CX
-    const RowMajorMatrixType& Cmatrix = C.getRowMajorValue();
-    const ColMajorMatrixType& CXmatrix = CX.getColMajorValue();
+    RowMajorView Cmatrix = C.getRowMajorValue();
+    ColMajorView CXmatrix = CX.getColMajorValue();
     QuantumState outerSize = Cmatrix.outerSize();
+    // A residue vanishes unless one of the weights is retained.
+    const std::vector<InnerQuantumState>& RetainedInner = DMpartInner.getRetainedStates();
+
+    if (Cmatrix.isDense() && CXmatrix.isDense()) {
+        // <index1|C|inner> and <inner|CX|index1> are stored in the columns, so the matrix elements of a given index1 are 
+        // a product of two contiguous vectors.
+        ColMajorDenseMatrixType CT = Cmatrix.dense().transpose();
+        ColMajorDenseMatrixType CXdense = CXmatrix.dense();
+        VectorType Products;
+        for(QuantumState index1=0; index1<outerSize; ++index1){
+            if(!DMpartOuter.isRetained(index1)){
+                for(std::vector<InnerQuantumState>::const_iterator inner = RetainedInner.begin(); inner != RetainedInner.end(); ++inner)
+                    addTransition(index1, *inner, CT(*inner,index1) * CXdense(*inner,index1));
+                continue;
+            }
+            Products.noalias() = CT.col(index1).cwiseProduct(CXdense.col(index1));
+            for(QuantumState inner=0; inner<QuantumState(Products.size()); ++inner)
+                addTransition(index1, inner, Products(inner));
+        }
+        return;
+    }
 
     // Iterate over all values of the outer index.
     // TODO: should be optimized - skip empty rows of Cmatrix and empty columns of CXmatrix.
     for(QuantumState index1=0; index1<outerSize; ++index1){
+        if(!DMpartOuter.isRetained(index1)){
+            for(std::vector<InnerQuantumState>::const_iterator inner = RetainedInner.begin(); inner != RetainedInner.end(); ++inner)
+                addTransition(index1, *inner, MelemType(Cmatrix.coeff(index1,*inner)) * MelemType(CXmatrix.coeff(*inner,index1)));
+            continue;
+        }
+
         // <index1|C|Cinner><CXinner|CX|index1>
-        RowMajorMatrixType::InnerIterator Cinner(Cmatrix,index1);
-        ColMajorMatrixType::InnerIterator CXinner(CXmatrix,index1);
+        RowMajorView::InnerIterator Cinner(Cmatrix,index1);
+        ColMajorView::InnerIterator CXinner(CXmatrix,index1);
 
         // While we are not at the last column of Cmatrix or at the last row of CXmatrix.
         while(Cinner && CXinner){
@@ -60,15 +108,7 @@ void GreensFunctionPart::compute(void)
 
             // A meaningful matrix element
             if(C_index2 == CX_index2){
-                ComplexType Residue = Cinner.value() * CXinner.value() *
-                                      (DMpartOuter.getWeight(index1) + DMpartInner.getWeight(C_index2));
-                if(abs(Residue) > MatrixElementTolerance) // Is the residue relevant?
-                {
-                    // Create a new term and append it to the list.
-                    RealType Pole = HpartInner.getEigenValue(C_index2) - HpartOuter.getEigenValue(index1);
-                    Terms.add_term(Term(Residue, Pole));
-                    //DEBUG("<" << C.S.getFockState(HpartInner.getBlockNumber(), C_index2) << "|" << Residue << "|" <<  C.S.getFockState(HpartInner.getBlockNumber(),CX_index2) << ">" );
-                };
+                addTransition(index1, C_index2, MelemType(Cinner.value()) * MelemType(CXinner.value()));
                 ++Cinner;   // The next non-zero element
                 ++CXinner;  // The next non-zero element
             }else{
@@ -78,8 +118,30 @@ void GreensFunctionPart::compute(void)
             }
         }
     }
+}
+
+void GreensFunctionPart::computeTerms(void)
+{
+    Terms.clear();
+
+    for(std::vector<Transition>::const_iterator t = Transitions->begin(); t != Transitions->end(); ++t){
+        ComplexType Residue = t->MatrixElement * (DMpartOuter.getWeight(t->Outer) + DMpartInner.getWeight(t->Inner));
+        if(abs(Residue) > MatrixElementTolerance) // Is the residue relevant?
+            Terms.add_term(Term(Residue, t->Pole));
+    }
 
     assert(Terms.check_terms());
 }
 
+void GreensFunctionPart::compute(void)
+{
+    if(!Transitions) computeTransitions();
+    computeTerms();
+}
+
+bool GreensFunctionPart::hasTransitions(void) const
+{
+    return Transitions.get() != NULL;
+}
+
 } // end of namespace Pomerol
@@ -26,6 +26,7 @@ void Hamiltonian::prepare(const boost::mpi::communicator& comm)
     for (BlockNumber CurrentBlock = 0; CurrentBlock < NumberOfBlocks; CurrentBlock++)
     {
 	    parts[CurrentBlock].reset(new HamiltonianPart(IndexInfo,F, S, CurrentBlock));
+	    parts[CurrentBlock]->Policy = Policy;
         //parts[CurrentBlock]->prepare();
     }
     pMPI::mpi_skel<pMPI::PrepareWrap<HamiltonianPart> > skel;
@@ -33,7 +34,9 @@ void Hamiltonian::prepare(const boost::mpi::communicator& comm)
     for (size_t i=0; i<parts.size(); i++) { skel.parts[i] = pMPI::PrepareWrap<HamiltonianPart>(*parts[i]);};
     std::map<pMPI::JobId, pMPI::WorkerId> job_map = skel.run(comm,false);
     comm.barrier();
+    PartOwners.resize(parts.size());
     for (size_t p = 0; p<parts.size(); p++) {
+            PartOwners[p] = job_map[p];
             if (comm.rank() == job_map[p]){
                 if (parts[p]->Status != HamiltonianPart::Prepared) { 
                     ERROR ("Worker" << comm.rank() << " didn't calculate part" << p); 
@@ -51,6 +54,60 @@ void Hamiltonian::prepare(const boost::mpi::communicator& comm)
 }
 
 
+void Hamiltonian::update(const std::vector<MelemType>& Coefficients, bool WarmStart, const boost::mpi::communicator& comm)
+{
+    if (Status < Prepared) throw (exStatusMismatch());
+    if (Coefficients.size() != size_t(std::distance(F.begin(),F.end()))) throw (std::logic_error("Hamiltonian::update : wrong number of coefficients."));
+    for (size_t p = 0; p<parts.size(); p++) {
+        // All processes hold the eigenvectors after compute(), so any of them can warm start the part.
+        // The compressed eigenvectors are not orthonormal to the double precision, so they can't be used for the warm start.
+        if (WarmStart && parts[p]->Status >= HamiltonianPart::Computed && !parts[p]->isCompressed()) { parts[p]->restore(); parts[p]->PreviousEigenvectors.swap(parts[p]->H); }
+        else parts[p]->PreviousEigenvectors.resize(0,0);
+        if (comm.rank() == PartOwners[p]) parts[p]->refill(Coefficients);
+        else { parts[p]->releaseScratch(); parts[p]->H.resize(parts[p]->getSize(),parts[p]->getSize()); };
+        boost::mpi::broadcast(comm, parts[p]->H.data(), parts[p]->getSize()*parts[p]->getSize(), PartOwners[p]);
+        parts[p]->Status = HamiltonianPart::Prepared;
+        };
+    Status = Prepared;
+}
+
+void Hamiltonian::update(const Operator& NewF, bool WarmStart, const boost::mpi::communicator& comm)
+{
+    std::map<Operator::monomial_t, MelemType> NewTerms(NewF.begin(), NewF.end());
+    std::vector<MelemType> Coefficients;
+    size_t found = 0;
+    for (Operator::const_iterator it=F.begin(); it!=F.end(); it++) {
+        std::map<Operator::monomial_t, MelemType>::const_iterator new_it = NewTerms.find(it->first);
+        if (new_it == NewTerms.end()) Coefficients.push_back(0.0);
+        else { Coefficients.push_back(new_it->second); found++; };
+        }
+    if (found != NewTerms.size()) throw (std::logic_error("Hamiltonian::update : the new operator has terms, which are absent in the structure of the Hamiltonian."));
+    update(Coefficients, WarmStart, comm);
+}
+
+void Hamiltonian::shift(const Operator& Shift)
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    // Find the value of the shift in every part first, so that nothing is changed if Shift doesn't fit.
+    std::vector<RealType> Values(parts.size(), 0.0);
+    for (BlockNumber CurrentBlock=0; CurrentBlock<S.NumberOfBlocks(); CurrentBlock++) {
+        const std::vector<FockState>& states = S.getFockStates(CurrentBlock);
+        for (size_t i=0; i<states.size(); i++) {
+            std::map<FockState, MelemType> result = Shift.actRight(states[i]);
+            MelemType value = (result.size() ? result.begin()->second : 0.0);
+            if (result.size() > 1 || (result.size() == 1 && result.begin()->first != states[i]))
+                throw (std::logic_error("Hamiltonian::shift : the operator is not diagonal in the FockState basis."));
+            if (std::abs(value - std::real(value)) > 100*std::numeric_limits<RealType>::epsilon())
+                throw (std::logic_error("Hamiltonian::shift : the operator is not hermitian."));
+            if (i == 0) Values[CurrentBlock] = std::real(value);
+            else if (std::abs(std::real(value) - Values[CurrentBlock]) > 100*std::numeric_limits<RealType>::epsilon())
+                throw (std::logic_error("Hamiltonian::shift : the operator is not constant within a block."));
+            }
+        }
+    for (size_t p = 0; p<parts.size(); p++) parts[p]->Eigenvalues.array() += Values[p];
+    computeGroundEnergy();
+}
+
 void Hamiltonian::compute(const boost::mpi::communicator & comm)
 {
     if (Status >= Computed) return;
@@ -73,13 +130,22 @@ void Hamiltonian::compute(const boost::mpi::communicator & comm)
                     };
                 boost::mpi::broadcast(comm, parts[p]->H.data(), parts[p]->H.rows()*parts[p]->H.cols(), rank);
                 boost::mpi::broadcast(comm, parts[p]->Eigenvalues.data(), parts[p]->H.rows(), rank);
+                boost::mpi::broadcast(comm, parts[p]->RealValued, rank);
+                int solver = parts[p]->Solver;
+                boost::mpi::broadcast(comm, solver, rank);
                 }
             else {
                 parts[p]->Eigenvalues.resize(parts[p]->H.rows());
                 boost::mpi::broadcast(comm, parts[p]->H.data(), parts[p]->H.rows()*parts[p]->H.cols(), job_map[p]);
                 boost::mpi::broadcast(comm, parts[p]->Eigenvalues.data(), parts[p]->H.rows(), job_map[p]);
+                boost::mpi::broadcast(comm, parts[p]->RealValued, job_map[p]);
+                int solver;
+                boost::mpi::broadcast(comm, solver, job_map[p]);
+                parts[p]->Solver = HamiltonianPart::SolverType(solver);
+                parts[p]->PreviousEigenvectors.resize(0,0);
                 parts[p]->Status = HamiltonianPart::Computed;
                  };
+            if (!ScratchDirectory.empty()) parts[p]->spill(ScratchDirectory);
             };
 /*
     for (BlockNumber CurrentBlock=0; CurrentBlock<NumberOfBlocks; CurrentBlock++)
@@ -92,22 +158,112 @@ void Hamiltonian::compute(const boost::mpi::communicator & comm)
     Status = Computed;
 }
 
+/** A wrap to distribute HamiltonianPart::computeEigenValues with pMPI::mpi_skel. */
+struct EigenValuesWrap {
+    HamiltonianPart *x;
+    int complexity;
+    EigenValuesWrap(HamiltonianPart &y, int complexity = 1):x(&y),complexity(complexity){};
+    void run(){x->computeEigenValues();}; 
+    EigenValuesWrap(){};
+};
+
+void Hamiltonian::computeEigenValues(const boost::mpi::communicator & comm)
+{
+    if (Status >= Computed) return;
+
+    pMPI::mpi_skel<EigenValuesWrap> skel;
+    skel.parts.resize(parts.size());
+    for (size_t i=0; i<parts.size(); i++) { skel.parts[i] = EigenValuesWrap(*parts[i],parts[i]->getSize());};
+    std::map<pMPI::JobId, pMPI::WorkerId> job_map = skel.run(comm, true);
+    int rank = comm.rank();
+
+    comm.barrier();
+    for (size_t p = 0; p<parts.size(); p++) {
+            if (rank == job_map[p]){
+                if (parts[p]->Status != HamiltonianPart::Computed) { 
+                    ERROR ("Worker" << rank << " didn't calculate part" << p); 
+                    throw (std::logic_error("Worker didn't calculate this part."));
+                    };
+                boost::mpi::broadcast(comm, parts[p]->Eigenvalues.data(), parts[p]->getSize(), rank);
+                int solver = parts[p]->Solver;
+                boost::mpi::broadcast(comm, solver, rank);
+                }
+            else {
+                parts[p]->Eigenvalues.resize(parts[p]->getSize());
+                boost::mpi::broadcast(comm, parts[p]->Eigenvalues.data(), parts[p]->getSize(), job_map[p]);
+                int solver;
+                boost::mpi::broadcast(comm, solver, job_map[p]);
+                parts[p]->Solver = HamiltonianPart::SolverType(solver);
+                parts[p]->H.resize(0,0);
+                parts[p]->PreviousEigenvectors.resize(0,0);
+                parts[p]->Status = HamiltonianPart::Computed;
+                 };
+            };
+    computeGroundEnergy();
+    Status = Computed;
+}
+
 void Hamiltonian::reduce(const RealType Cutoff)
 {
-    std::cout << "Performing EV cutoff at " << Cutoff << " level" << std::endl;
+    if (Status < Computed) throw (exStatusMismatch());
+    INFO_NONEWLINE("Performing EV cutoff at " << Cutoff << " level : ");
     BlockNumber NumberOfBlocks = parts.size();
+    unsigned long Retained = 0;
     for (BlockNumber CurrentBlock=0; CurrentBlock<NumberOfBlocks; CurrentBlock++)
     {
-	parts[CurrentBlock]->reduce(GroundEnergy+Cutoff);
+	    parts[CurrentBlock]->reduce(GroundEnergy+Cutoff);
+        if (!ScratchDirectory.empty()) parts[CurrentBlock]->spill(ScratchDirectory);
+        Retained += parts[CurrentBlock]->getNumberOfEigenStates();
     }
+    INFO(Retained << " of " << S.getNumberOfStates() << " states retained.");
+}
+
+void Hamiltonian::setEigensolverPolicy(const EigensolverPolicy& Policy)
+{
+    this->Policy = Policy;
+    for (size_t p = 0; p<parts.size(); p++) parts[p]->Policy = Policy;
+}
+
+const EigensolverPolicy& Hamiltonian::getEigensolverPolicy() const
+{
+    return Policy;
+}
+
+void Hamiltonian::setScratchDirectory(const std::string& Directory)
+{
+    ScratchDirectory = Directory;
+    if (Status < Computed) return;
+    for (size_t p = 0; p<parts.size(); p++) {
+        if (ScratchDirectory.empty()) parts[p]->restore();
+        else parts[p]->spill(ScratchDirectory);
+        }
+}
+
+RealType Hamiltonian::compress(void)
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    RealType Error = 0.0;
+    for (size_t p = 0; p<parts.size(); p++) Error = std::max(Error, parts[p]->compress());
+    #ifdef POMEROL_FLOAT_STORAGE
+    INFO("Eigenvectors are stored in single precision, the largest error is " << Error);
+    #endif
+    return Error;
+}
+
+void Hamiltonian::releaseEigenvectors(const std::set<BlockNumber>& Blocks)
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    for (std::set<BlockNumber>::const_iterator it = Blocks.begin(); it != Blocks.end(); it++) parts[*it]->releaseEigenvectors();
 }
 
 void Hamiltonian::computeGroundEnergy()
 {
     RealVectorType LEV(size_t(S.NumberOfBlocks()));
     BlockNumber NumberOfBlocks = parts.size();
+    LEV.setConstant(std::numeric_limits<RealType>::infinity());
     for (BlockNumber CurrentBlock=0; CurrentBlock<NumberOfBlocks; CurrentBlock++) {
-	    LEV(CurrentBlock,0) = parts[CurrentBlock]->getMinimumEigenvalue();
+        // The parts may be left empty by reduce()
+        if (parts[CurrentBlock]->getNumberOfEigenStates()) LEV(int(CurrentBlock)) = parts[CurrentBlock]->getMinimumEigenvalue();
     }
     GroundEnergy=LEV.minCoeff();
 }
@@ -130,7 +286,9 @@ RealType Hamiltonian::getEigenValue(QuantumState state) const
 
 RealVectorType Hamiltonian::getEigenValues() const
 {
-    RealVectorType out(S.getNumberOfStates());
+    size_t Size = 0;
+    for (BlockNumber CurrentBlock=0; CurrentBlock<S.NumberOfBlocks(); CurrentBlock++) Size += parts[CurrentBlock]->getNumberOfEigenStates();
+    RealVectorType out(Size);
     size_t i=0;
     for (BlockNumber CurrentBlock=0; CurrentBlock<S.NumberOfBlocks(); CurrentBlock++) {
         const RealVectorType& tmp = parts[CurrentBlock]->getEigenValues();
@@ -1,7 +1,15 @@
 #include"pomerol/HamiltonianPart.h"
 #include"pomerol/StatesClassification.h"
 #include<sstream>
+#include<algorithm>
+#include<map>
 #include<Eigen/Eigenvalues>
+#include<Eigen/Jacobi>
+#include<cstdlib>
+#include<cstring>
+#include<stdexcept>
+#include<sys/mman.h>
+#include<unistd.h>
 
 #ifdef ENABLE_SAVE_PLAINTEXT
 #include<boost/filesystem.hpp>
@@ -16,34 +24,60 @@ HamiltonianPart::HamiltonianPart(const IndexClassification& IndexInfo, const Ind
     ComputableObject(),
     IndexInfo(IndexInfo),
     F(F), S(S),
-    Block(Block), QN(S.getQuantumNumbers(Block))
+    Block(Block), QN(S.getQuantumNumbers(Block)), RealValued(true), Solver(Dense), Mapped(0), MappedRows(0), MappedCols(0)
 {
 }
 
+HamiltonianPart::~HamiltonianPart()
+{
+    releaseScratch();
+}
+
 void HamiltonianPart::prepare()
 {
-    size_t BlockSize = S.getBlockSize(Block);
+    prepareStructure();
+    std::vector<MelemType> Coefficients;
+    Coefficients.reserve(std::distance(F.begin(),F.end()));
+    for (Operator::const_iterator term_it=F.begin(); term_it!=F.end(); term_it++) Coefficients.push_back(term_it->second);
+    refill(Coefficients);
+}
 
-    H.resize(BlockSize,BlockSize);
-    H.setZero();
-    std::map<FockState,MelemType>::const_iterator melem_it;
+void HamiltonianPart::prepareStructure()
+{
+    size_t BlockSize = S.getBlockSize(Block);
+    Pattern.clear();
 
     for(InnerQuantumState right_st=0; right_st<BlockSize; right_st++)
     {
         FockState ket = S.getFockState(Block,right_st);
-        std::map<FockState,MelemType> mapStates = F.actRight(ket);
-        for (melem_it=mapStates.begin(); melem_it!=mapStates.end(); melem_it++) {
-            FockState bra = melem_it -> first;
-            MelemType melem = melem_it -> second;
-            //DEBUG("<" << bra << "|" << melem << "|" << F << "|" << ket << ">");
+        size_t term=0;
+        for (Operator::const_iterator term_it=F.begin(); term_it!=F.end(); term_it++, term++) {
+            FockState bra;
+            MelemType sign;
+            boost::tie(bra,sign) = Operator::actRight(term_it->first,ket);
+            if (bra == ERROR_FOCK_STATE || std::abs(sign) < std::numeric_limits<RealType>::epsilon()) continue;
             InnerQuantumState left_st = S.getInnerState(bra);
-//            if (left_st > right_st) { ERROR("!"); exit(1); };
-            H(left_st,right_st) = melem;
+            #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+            Pattern.push_back(PatternEntry(left_st,right_st,term,std::real(sign)));
+            #else
+            Pattern.push_back(PatternEntry(left_st,right_st,term,sign));
+            #endif
         }
     }
+    // Column-major order of H is the order of the streaming refill.
+    std::sort(Pattern.begin(), Pattern.end());
+}
+
+void HamiltonianPart::refill(const std::vector<MelemType>& Coefficients)
+{
+    size_t BlockSize = S.getBlockSize(Block);
+
+    releaseScratch();
+    H.resize(BlockSize,BlockSize);
+    H.setZero();
+    for (std::vector<PatternEntry>::const_iterator it=Pattern.begin(); it!=Pattern.end(); it++)
+        H(it->Row,it->Col) += it->Sign * Coefficients[it->Term];
 
-//    H.triangularView<Eigen::Lower>() = H.triangularView<Eigen::Upper>().transpose();
-//    assert(MatrixType(H.triangularView<Eigen::Lower>()) == MatrixType(H.triangularView<Eigen::Upper>().transpose()));
     assert((H.adjoint() - H).array().abs().maxCoeff() < 100*std::numeric_limits<RealType>::epsilon());
     Status = Prepared;
 }
@@ -51,30 +85,237 @@ void HamiltonianPart::prepare()
 void HamiltonianPart::compute()		//method of diagonalization classificated part of Hamiltonian
 {
     if (Status >= Computed) return;
-    if (H.rows() == 1) {
-        #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
-        assert (std::abs(H(0,0) - std::real(H(0,0))) < std::numeric_limits<RealType>::epsilon());
-        #endif
-        Eigenvalues.resize(1);
+    #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+    RealValued = (H.imag().cwiseAbs().maxCoeff() < 100*std::numeric_limits<RealType>::epsilon());
+    #endif
+    if (PreviousEigenvectors.rows() == H.rows() && PreviousEigenvectors.cols() == H.cols() && H.rows() > 1 && computeWarmStart()) {
+        PreviousEigenvectors.resize(0,0);
         #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
-	    Eigenvalues << std::real(H(0,0));
-        #else
-	    Eigenvalues << H(0,0);
+        // Complex previous eigenvectors keep their phases even if the part became real.
+        RealValued = RealValued && (H.imag().cwiseAbs().maxCoeff() < 100*std::numeric_limits<RealType>::epsilon());
         #endif
-	    H(0,0) = 1;
+        Solver = WarmStart;
+        Status = Computed;
+        return;
+        };
+    PreviousEigenvectors.resize(0,0);
+    diagonalize(true);
+    Status = Computed;
+}
+
+void HamiltonianPart::computeEigenValues()
+{
+    if (Status >= Computed) return;
+    #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+    RealValued = (H.imag().cwiseAbs().maxCoeff() < 100*std::numeric_limits<RealType>::epsilon());
+    #endif
+    PreviousEigenvectors.resize(0,0);
+    diagonalize(false);
+    H.resize(0,0);
+    Status = Computed;
+}
+
+namespace {
+
+/** Find the representative of the subblock of a state, halving the paths on the way. */
+InnerQuantumState findRoot(std::vector<InnerQuantumState>& Parent, InnerQuantumState i)
+{
+    while (Parent[i] != i) { Parent[i] = Parent[Parent[i]]; i = Parent[i]; };
+    return i;
+}
+
+} // end of anonymous namespace
+
+void HamiltonianPart::diagonalize(bool ComputeVectors)
+{
+    InnerQuantumState Size = H.rows();
+    RealType Threshold = Policy.ZeroTolerance * H.cwiseAbs().maxCoeff();
+
+    // The subblocks are the connected components of the graph of the nonzero elements of H.
+    std::vector<InnerQuantumState> Parent(Size), Degree(Size, 0), Link(2*Size, 0);
+    for (InnerQuantumState i=0; i<Size; i++) Parent[i] = i;
+    bool Analyze = (Size >= std::max(Policy.MinAnalysisSize, InnerQuantumState(2)));
+    for (InnerQuantumState i=0; i<Size && Analyze; i++)
+        for (InnerQuantumState j=i+1; j<Size; j++) {
+            if (std::abs(H(i,j)) <= Threshold) continue;
+            // The first two neighbours are enough to follow a chain.
+            if (Degree[i] < 2) Link[2*i+Degree[i]] = j;
+            if (Degree[j] < 2) Link[2*j+Degree[j]] = i;
+            Degree[i]++; Degree[j]++;
+            Parent[findRoot(Parent,i)] = findRoot(Parent,j);
+            }
+    // A chain has to be connected, so the chains are not searched in a single disconnected block.
+    bool FindChains = Analyze && Policy.Tridiagonal;
+    if (!Analyze || !Policy.Decompose) {
+        for (InnerQuantumState i=1; i<Size; i++) FindChains = FindChains && (findRoot(Parent,i) == findRoot(Parent,0));
+        for (InnerQuantumState i=0; i<Size; i++) Parent[i] = 0;
+        }
+
+    // Group the states by subblocks, in the order of the first state of each subblock.
+    std::map<InnerQuantumState, size_t> BlockIndex;
+    std::vector<std::vector<InnerQuantumState> > Blocks;
+    std::vector<unsigned long> Edges;
+    std::vector<InnerQuantumState> MaxDegree;
+    for (InnerQuantumState i=0; i<Size; i++) {
+        InnerQuantumState root = findRoot(Parent,i);
+        std::map<InnerQuantumState, size_t>::iterator it = BlockIndex.find(root);
+        if (it == BlockIndex.end()) {
+            it = BlockIndex.insert(std::make_pair(root, Blocks.size())).first;
+            Blocks.push_back(std::vector<InnerQuantumState>());
+            Edges.push_back(0);
+            MaxDegree.push_back(0);
+            };
+        Blocks[it->second].push_back(i);
+        Edges[it->second] += Degree[i];
+        MaxDegree[it->second] = std::max(MaxDegree[it->second], Degree[i]);
+        }
+
+    // Each edge is counted twice in Edges. A connected subblock with BlockSize-1 edges and no branches is a chain.
+    std::vector<bool> Chains(Blocks.size());
+    for (size_t b=0; b<Blocks.size(); b++)
+        Chains[b] = FindChains && MaxDegree[b] <= 2 && Edges[b] == 2*(Blocks[b].size()-1) && Blocks[b].size() > 2;
+
+    std::vector<std::pair<RealType, InnerQuantumState> > Order;
+    Order.reserve(Size);
+    ColMajorDenseMatrixType Vectors;
+    RealVectorType Values;
+    if (Blocks.size() == 1 && !Chains[0]) {
+        // A single subblock, which is not a chain : no need to copy H.
+        Solver = solveBlock(H, false, ComputeVectors, Values, Vectors);
+        for (InnerQuantumState k=0; k<Size; k++) Order.push_back(std::make_pair(Values(k), k));
         }
     else {
-	    Eigen::SelfAdjointEigenSolver<MatrixType> Solver(H,Eigen::ComputeEigenvectors);
-	    H = Solver.eigenvectors();
-	    Eigenvalues = Solver.eigenvalues();	// eigenvectors are ready
-    }
-    Status = Computed;
+        if (ComputeVectors) Vectors = ColMajorDenseMatrixType::Zero(Size, Size);
+        bool AllTrivial = true;
+        for (size_t b=0; b<Blocks.size(); b++) {
+            std::vector<InnerQuantumState>& States = Blocks[b];
+            InnerQuantumState BlockSize = States.size();
+            if (Chains[b]) {
+                // Reorder the states along the chain, starting from one of its ends.
+                InnerQuantumState current = States[0];
+                for (InnerQuantumState k=0; k<BlockSize; k++) if (Degree[States[k]] == 1) { current = States[k]; break; };
+                InnerQuantumState previous = current;
+                for (InnerQuantumState k=0; k<BlockSize; k++) {
+                    States[k] = current;
+                    InnerQuantumState next = (Link[2*current] == previous && k > 0 ? Link[2*current+1] : Link[2*current]);
+                    previous = current;
+                    current = next;
+                    }
+                };
+            ColMajorDenseMatrixType M(BlockSize, BlockSize);
+            for (InnerQuantumState k=0; k<BlockSize; k++)
+                for (InnerQuantumState l=0; l<BlockSize; l++) M(k,l) = H(States[k],States[l]);
+            RealVectorType BlockValues;
+            ColMajorDenseMatrixType BlockVectors;
+            SolverType BlockSolver = solveBlock(M, Chains[b], ComputeVectors, BlockValues, BlockVectors);
+            AllTrivial = AllTrivial && (BlockSize == 1);
+            for (InnerQuantumState k=0; k<BlockSize; k++) {
+                Order.push_back(std::make_pair(BlockValues(k), Order.size()));
+                if (ComputeVectors) for (InnerQuantumState l=0; l<BlockSize; l++) Vectors(States[l], Order.size()-1) = BlockVectors(l,k);
+                }
+            if (Blocks.size() == 1) Solver = BlockSolver;
+            }
+        if (Blocks.size() > 1) Solver = (AllTrivial ? Diagonal : BlockDiagonal);
+        }
+
+    // Keep the eigenvalues in ascending order, as the dense solver does.
+    std::stable_sort(Order.begin(), Order.end());
+    Eigenvalues.resize(Size);
+    bool Sorted = true;
+    for (InnerQuantumState k=0; k<Size; k++) { Eigenvalues(k) = Order[k].first; Sorted = Sorted && (Order[k].second == k); };
+    if (!ComputeVectors) return;
+    if (Sorted) H.swap(Vectors);
+    else for (InnerQuantumState k=0; k<Size; k++) H.col(k) = Vectors.col(Order[k].second);
 }
 
+HamiltonianPart::SolverType HamiltonianPart::solveBlock(const ColMajorDenseMatrixType& M, bool Chain, bool ComputeVectors, RealVectorType& Values, ColMajorDenseMatrixType& Vectors) const
+{
+    InnerQuantumState Size = M.rows();
+    if (Size == 1) {
+        Values.resize(1);
+        Values << std::real(M(0,0));
+        if (ComputeVectors) Vectors = ColMajorDenseMatrixType::Ones(1,1);
+        return Diagonal;
+        }
+    if (Chain) {
+        // A diagonal unitary D with the phases of the chain makes D^+ M D real and symmetric.
+        RealVectorType Diag(Size), SubDiag(Size-1);
+        VectorType Phases(Size);
+        Phases(0) = 1.0;
+        for (InnerQuantumState k=0; k<Size; k++) Diag(k) = std::real(M(k,k));
+        for (InnerQuantumState k=0; k+1<Size; k++) {
+            RealType b = std::abs(M(k+1,k));
+            SubDiag(k) = b;
+            Phases(k+1) = (b > 0 ? Phases(k) * M(k+1,k) / b : Phases(k));
+            }
+        Eigen::SelfAdjointEigenSolver<RealColMajorDenseMatrixType> Eigensolver;
+        Eigensolver.computeFromTridiagonal(Diag, SubDiag, ComputeVectors ? Eigen::ComputeEigenvectors : Eigen::EigenvaluesOnly);
+        Values = Eigensolver.eigenvalues();
+        if (ComputeVectors) Vectors = Phases.asDiagonal() * Eigensolver.eigenvectors().cast<MelemType>();
+        return Tridiagonal;
+        }
+    #ifdef POMEROL_COMPLEX_MATRIX_ELEMENTS
+    if (RealValued) {
+        // The same spectrum for about a quarter of the flops of the complex solver.
+        Eigen::SelfAdjointEigenSolver<RealColMajorDenseMatrixType> Eigensolver(RealColMajorDenseMatrixType(M.real()), ComputeVectors ? Eigen::ComputeEigenvectors : Eigen::EigenvaluesOnly);
+        Values = Eigensolver.eigenvalues();
+        if (ComputeVectors) Vectors = Eigensolver.eigenvectors().cast<MelemType>();
+        return Dense;
+        }
+    #endif
+    Eigen::SelfAdjointEigenSolver<ColMajorDenseMatrixType> Eigensolver(M, ComputeVectors ? Eigen::ComputeEigenvectors : Eigen::EigenvaluesOnly);
+    Values = Eigensolver.eigenvalues();
+    if (ComputeVectors) Vectors = Eigensolver.eigenvectors();
+    return Dense;
+}
+
+bool HamiltonianPart::computeWarmStart()
+{
+    const int MaxSweeps = 4;
+    InnerQuantumState Size = H.rows();
+    // A rotation costs O(Size) operations, the dense solver costs O(Size^3).
+    // Give up, once the rotations become more expensive than a diagonalization from scratch.
+    unsigned long RotationsBudget = Size*Size/4;
+
+    ColMajorDenseMatrixType A = PreviousEigenvectors.adjoint() * H * PreviousEigenvectors;
+    RealType Tolerance = 100*std::numeric_limits<RealType>::epsilon()*std::max(A.norm(), RealType(1.0));
+
+    unsigned long Rotations = 0;
+    bool converged = false;
+    for (int sweep=0; sweep<MaxSweeps && !converged; sweep++) {
+        converged = true;
+        for (InnerQuantumState p=0; p<Size; p++)
+            for (InnerQuantumState q=p+1; q<Size; q++) {
+                if (std::abs(A(p,q)) <= Tolerance) continue;
+                converged = false;
+                if (++Rotations > RotationsBudget) return false;
+                Eigen::JacobiRotation<MelemType> J;
+                J.makeJacobi(A, p, q);
+                A.applyOnTheLeft(p, q, J.adjoint());
+                A.applyOnTheRight(p, q, J);
+                PreviousEigenvectors.applyOnTheRight(p, q, J);
+            }
+    }
+    if (!converged) return false;
+
+    // Keep the eigenvalues in ascending order, as the dense solver does.
+    std::vector<std::pair<RealType, InnerQuantumState> > Order(Size);
+    for (InnerQuantumState i=0; i<Size; i++) Order[i] = std::make_pair(std::real(A(i,i)), i);
+    std::sort(Order.begin(), Order.end());
+    Eigenvalues.resize(Size);
+    for (InnerQuantumState i=0; i<Size; i++) {
+        Eigenvalues(i) = Order[i].first;
+        H.col(i) = PreviousEigenvectors.col(Order[i].second);
+        }
+    return true;
+}
 
 MelemType HamiltonianPart::getMatrixElement(InnerQuantumState m, InnerQuantumState n) const	//return  H(m,n)
 {
-    return H(m,n);
+    #ifdef POMEROL_FLOAT_STORAGE
+    if (CompressedH.size()) return MelemType(CompressedH(m,n));
+    #endif
+    return (Mapped ? Mapped[n*MappedRows + m] : H(m,n));
 }
 
 RealType HamiltonianPart::getEigenValue(InnerQuantumState state) const // return Eigenvalues(state)
@@ -94,6 +335,11 @@ InnerQuantumState HamiltonianPart::getSize(void) const
     return S.getBlockSize(Block);
 }
 
+InnerQuantumState HamiltonianPart::getNumberOfEigenStates(void) const
+{
+    return Eigenvalues.size();
+}
+
 BlockNumber HamiltonianPart::getBlockNumber(void) const
 {
     return S.getBlockNumber(QN);
@@ -108,18 +354,41 @@ QuantumNumbers HamiltonianPart::getQuantumNumbers(void) const
 
 void HamiltonianPart::print_to_screen() const
 {
-    INFO(H << std::endl);
+    #ifdef POMEROL_FLOAT_STORAGE
+    if (CompressedH.size()) { INFO(CompressedH << std::endl); return; };
+    #endif
+    INFO(getMatrix() << std::endl);
 }
 
-const MatrixType& HamiltonianPart::getMatrix() const
+Eigen::Map<const ColMajorDenseMatrixType> HamiltonianPart::getMatrix() const
 {
-    return H;
+    if (isCompressed()) throw (exStatusMismatch());
+    if (Mapped) return Eigen::Map<const ColMajorDenseMatrixType>(Mapped, MappedRows, MappedCols);
+    return Eigen::Map<const ColMajorDenseMatrixType>(H.data(), H.rows(), H.cols());
 }
 
-VectorType HamiltonianPart::getEigenState(InnerQuantumState state) const
+#ifdef POMEROL_FLOAT_STORAGE
+const StorageColMajorDenseMatrixType& HamiltonianPart::getCompressedMatrix() const
 {
-    if ( Status < Computed ) throw (exStatusMismatch());
-    return H.col(state);
+    return CompressedH;
+}
+#endif
+
+Eigen::Map<const VectorType> HamiltonianPart::getEigenState(InnerQuantumState state) const
+{
+    if ( Status < Computed || state >= getNumberOfEigenStates()) throw (exStatusMismatch());
+    Eigen::Map<const ColMajorDenseMatrixType> U = getMatrix();
+    return Eigen::Map<const VectorType>(U.data() + state*U.rows(), U.rows());
+}
+
+HamiltonianPart::SolverType HamiltonianPart::getSolver() const
+{
+    return Solver;
+}
+
+bool HamiltonianPart::isReal() const
+{
+    return RealValued;
 }
 
 RealType HamiltonianPart::getMinimumEigenvalue() const
@@ -132,15 +401,111 @@ bool HamiltonianPart::reduce(RealType ActualCutoff)
 {
     if ( Status < Computed ) throw (exStatusMismatch());
     InnerQuantumState counter=0;
+    // The eigenvalues are sorted in ascending order
     for (counter=0; (counter< (unsigned int)Eigenvalues.size() && Eigenvalues[counter]<=ActualCutoff); ++counter){};
-    std::cout << "Left " << counter << " eigenvalues : " << std::endl;
-    if (counter)
-	{std::cout << Eigenvalues.head(counter) << std::endl << "_________" << std::endl;
-	Eigenvalues = Eigenvalues.head(counter);
-	H = H.topLeftCorner(counter,counter);
-	return true;
-    }
-    else return false;
+    // The eigenvectors are the columns of H, all their components in the FockState basis are kept.
+    restore();
+    Eigenvalues = Eigenvalues.head(counter).eval();
+    H = H.leftCols(counter).eval();
+    return (counter > 0);
+}
+
+void HamiltonianPart::spill(const std::string& Directory)
+{
+    if ( Status < Computed ) throw (exStatusMismatch());
+    if ( Mapped || H.size() == 0 ) return;
+
+    std::string Name = Directory + "/pomerol_evecs_XXXXXX";
+    std::vector<char> Template(Name.begin(), Name.end());
+    Template.push_back('\0');
+    int fd = mkstemp(&Template[0]);
+    if (fd < 0) throw (std::runtime_error("HamiltonianPart::spill : can't create a scratch file in " + Directory + "."));
+    // The mapping keeps the data available, the name is not needed anymore.
+    unlink(&Template[0]);
+
+    size_t Bytes = H.size()*sizeof(MelemType);
+    const char *data = reinterpret_cast<const char*>(H.data());
+    for (size_t written = 0; written < Bytes; ) {
+        ssize_t n = write(fd, data + written, Bytes - written);
+        if (n <= 0) { close(fd); throw (std::runtime_error("HamiltonianPart::spill : can't write the scratch file in " + Directory + ".")); };
+        written += n;
+        }
+    void *addr = mmap(0, Bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) throw (std::runtime_error("HamiltonianPart::spill : can't map the scratch file."));
+
+    Mapped = static_cast<MelemType*>(addr);
+    MappedRows = H.rows();
+    MappedCols = H.cols();
+    H.resize(0,0);
+}
+
+bool HamiltonianPart::isSpilled(void) const
+{
+    return (Mapped != 0);
+}
+
+void HamiltonianPart::evict(void) const
+{
+    if (Mapped) madvise(Mapped, MappedRows*MappedCols*sizeof(MelemType), MADV_DONTNEED);
+}
+
+RealType HamiltonianPart::compress(void)
+{
+    if ( Status < Computed ) throw (exStatusMismatch());
+    #ifdef POMEROL_FLOAT_STORAGE
+    if ( CompressedH.size() ) return 0.0;
+    restore();
+    CompressedH = H.cast<StorageMelemType>();
+    RealType Error = (CompressedH.size() ? (CompressedH.cast<MelemType>() - H).cwiseAbs().maxCoeff() : 0.0);
+    H.resize(0,0);
+    return Error;
+    #else
+    return 0.0;
+    #endif
+}
+
+bool HamiltonianPart::isCompressed(void) const
+{
+    #ifdef POMEROL_FLOAT_STORAGE
+    return (CompressedH.size() > 0);
+    #else
+    return false;
+    #endif
+}
+
+void HamiltonianPart::releaseEigenvectors(void)
+{
+    if ( Status < Computed ) throw (exStatusMismatch());
+    releaseScratch();
+    H.resize(0,0);
+    PreviousEigenvectors.resize(0,0);
+}
+
+bool HamiltonianPart::hasEigenvectors(void) const
+{
+    return (H.size() > 0 || Mapped || isCompressed() || getNumberOfEigenStates() == 0);
+}
+
+void HamiltonianPart::restore(void)
+{
+    #ifdef POMEROL_FLOAT_STORAGE
+    if (CompressedH.size()) { H = CompressedH.cast<MelemType>(); CompressedH.resize(0,0); };
+    #endif
+    if (!Mapped) return;
+    H = getMatrix();
+    releaseScratch();
+}
+
+void HamiltonianPart::releaseScratch(void)
+{
+    #ifdef POMEROL_FLOAT_STORAGE
+    CompressedH.resize(0,0);
+    #endif
+    if (!Mapped) return;
+    munmap(Mapped, MappedRows*MappedCols*sizeof(MelemType));
+    Mapped = 0;
+    MappedRows = MappedCols = 0;
 }
 
 #ifdef ENABLE_SAVE_PLAINTEXT
@@ -156,9 +521,9 @@ bool HamiltonianPart::savetxt(const boost::filesystem::path &path1)
         out << __num_format<RealVectorType>(Eigenvalues - RealMatrixType::Identity(Eigenvalues.size(),Eigenvalues.size()).diagonal()*getMinimumEigenvalue()) << std::endl;
         out.close();
         };
-    if (Status >= Prepared) {
+    if (Status >= Prepared && !isCompressed()) {
         out.open(path1 / boost::filesystem::path("evecs.dat"),std::ios_base::out);
-        out << H << std::endl;
+        out << getMatrix() << std::endl;
         out.close();
         };
     out.open(path1 / boost::filesystem::path("info.dat"),std::ios_base::out);
@@ -0,0 +1,263 @@
+#include "pomerol/Planner.h"
+#include "pomerol/OperatorPresets.h"
+#include "pomerol/TwoParticleGFPart.h"
+
+#include <sstream>
+
+namespace Pomerol{
+
+namespace {
+
+/** The cost of a complex flop in the units of a real one. */
+const RealType ScalarFactor = (sizeof(MelemType) == sizeof(RealType) ? 1.0 : 4.0);
+
+/** A human readable amount of memory. */
+std::string format_bytes(RealType Bytes)
+{
+    const char* Units[] = {"B", "KB", "MB", "GB", "TB"};
+    size_t u = 0;
+    for (; Bytes >= 1024.0 && u < 4; u++) Bytes /= 1024.0;
+    std::stringstream out;
+    out << std::fixed << std::setprecision(u ? 1 : 0) << Bytes << " " << Units[u];
+    return out.str();
+}
+
+/** A number in the scientific notation. */
+std::string format_number(RealType Value)
+{
+    std::stringstream out;
+    out << std::scientific << std::setprecision(2) << Value;
+    return out.str();
+}
+
+} // end of anonymous namespace
+
+Planner::BlockEstimate::BlockEstimate(BlockNumber Block, const QuantumNumbers& QN, InnerQuantumState Size):
+    Block(Block), QN(QN), Size(Size)
+{
+    RealType d = Size;
+    // Householder tridiagonalization, QR iterations with the accumulation of the eigenvectors and the back transformation.
+    Flops = 9.0 * ScalarFactor * d * d * d;
+    Bytes = d * d * sizeof(MelemType) + d * sizeof(RealType);
+    // The solver keeps its own copy of the matrix for the eigenvectors.
+    PeakBytes = 2.0 * d * d * sizeof(MelemType) + 3.0 * d * sizeof(RealType);
+}
+
+Planner::Planner(const IndexClassification &IndexInfo, const StatesClassification &S):
+    ComputableObject(), IndexInfo(IndexInfo), S(S)
+{}
+
+void Planner::mapBlocks(ParticleIndex Index)
+{
+    if (CdagMaps.count(Index)) return;
+    OperatorPresets::Cdag Cdag(Index);
+    std::map<BlockNumber, BlockNumber> &CdagMap = CdagMaps[Index], &CMap = CMaps[Index];
+    for (BlockNumber Right=0; Right<S.NumberOfBlocks(); Right++) {
+        // The same as FieldOperator::mapsTo : the first state, which is not annihilated, defines the block.
+        const std::vector<FockState> &states = S.getFockStates(Right);
+        for (std::vector<FockState>::const_iterator state_it=states.begin(); state_it!=states.end(); state_it++) {
+            std::map<FockState, MelemType> result = Cdag.actRight(*state_it);
+            if (result.size()) {
+                BlockNumber Left = S.getBlockNumber(result.begin()->first);
+                CdagMap[Right] = Left;
+                CMap[Left] = Right;
+                break;
+                };
+            }
+        }
+}
+
+BlockNumber Planner::mapsTo(const std::map<BlockNumber, BlockNumber>& Map, BlockNumber Right) const
+{
+    std::map<BlockNumber, BlockNumber>::const_iterator it = Map.find(Right);
+    return (it != Map.end()) ? it->second : ERROR_BLOCK_NUMBER;
+}
+
+BlockNumber Planner::mapsTo(const IndexCombination4& Indices, size_t Operator, BlockNumber Right) const
+{
+    switch(Operator){
+        case 0: return mapsTo(CMaps.find(Indices.Index1)->second, Right);
+        case 1: return mapsTo(CMaps.find(Indices.Index2)->second, Right);
+        case 2: return mapsTo(CdagMaps.find(Indices.Index3)->second, Right);
+        // The inverse maps of the same operators
+        case 3: return mapsTo(CdagMaps.find(Indices.Index1)->second, Right);
+        case 4: return mapsTo(CdagMaps.find(Indices.Index2)->second, Right);
+        case 5: return mapsTo(CMaps.find(Indices.Index3)->second, Right);
+        default: return ERROR_BLOCK_NUMBER;
+    }
+}
+
+void Planner::compute(const std::set<ParticleIndex>& Indices, const std::set<IndexCombination2>& GFIndices,
+                      const std::set<IndexCombination4>& TwoParticleGFIndices)
+{
+    if (Status >= Computed) return;
+
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++) Blocks.push_back(BlockEstimate(b, S.getQuantumNumbers(b), S.getBlockSize(b)));
+
+    for (std::set<ParticleIndex>::const_iterator it=Indices.begin(); it!=Indices.end(); it++) {
+        mapBlocks(*it);
+        OperatorEstimate Estimate;
+        Estimate.Index = *it;
+        Estimate.Parts = CdagMaps[*it].size();
+        Estimate.NonZeros = Estimate.Flops = 0;
+        for (std::map<BlockNumber, BlockNumber>::const_iterator map_it=CdagMaps[*it].begin(); map_it!=CdagMaps[*it].end(); map_it++) {
+            RealType From = S.getBlockSize(map_it->first), To = S.getBlockSize(map_it->second);
+            Estimate.NonZeros += From * To;
+            Estimate.Flops += 2.0 * ScalarFactor * To * From * From;
+            }
+        // Row and column ordered copies of c^+_i, c_i is a view of them. The sparse storage is the largest
+        // just below the fill ratio of the switch to the dense storage.
+        Estimate.Bytes = Estimate.NonZeros * std::max(2.0 * FieldOperatorPart::DenseFillRatio * (sizeof(StorageMelemType) + sizeof(int)), 
+                                                      RealType(sizeof(StorageMelemType)));
+        Operators.push_back(Estimate);
+        }
+
+    for (std::set<IndexCombination2>::const_iterator it=GFIndices.begin(); it!=GFIndices.end(); it++) {
+        mapBlocks(it->Index1);
+        mapBlocks(it->Index2);
+        GFEstimate Estimate(*it);
+        // <Left|c_1|Right><Right|c^+_2|Left>
+        for (BlockNumber Right=0; Right<S.NumberOfBlocks(); Right++) {
+            BlockNumber Left = mapsTo(CMaps[it->Index1], Right);
+            if (Left == ERROR_BLOCK_NUMBER || mapsTo(CdagMaps[it->Index2], Left) != Right) continue;
+            Estimate.Parts++;
+            Estimate.Terms += RealType(S.getBlockSize(Left)) * S.getBlockSize(Right);
+            }
+        Estimate.Bytes = Estimate.Terms * (sizeof(ComplexType) + sizeof(RealType));
+        GFs.push_back(Estimate);
+        }
+
+    for (std::set<IndexCombination4>::const_iterator it=TwoParticleGFIndices.begin(); it!=TwoParticleGFIndices.end(); it++) {
+        mapBlocks(it->Index1);
+        mapBlocks(it->Index2);
+        mapBlocks(it->Index3);
+        mapBlocks(it->Index4);
+        TwoParticleGFEstimate Estimate(*it);
+        RealType Combinations = 0;
+        // The same sequences of blocks as in TwoParticleGF::prepare
+        // <B0|O_1|B1><B1|O_2|B2><B2|O_3|B3><B3|c^+_4|B0> for all permutations of (c_1, c_2, c^+_3).
+        for (BlockNumber B0=0; B0<S.NumberOfBlocks(); B0++) {
+            BlockNumber B3 = mapsTo(CdagMaps[it->Index4], B0);
+            if (B3 == ERROR_BLOCK_NUMBER) continue;
+            for (size_t p=0; p<6; ++p) {
+                BlockNumber B2 = mapsTo(*it, permutations3[p].perm[2], B3);
+                BlockNumber B1 = mapsTo(*it, permutations3[p].perm[0] + 3, B0);
+                if (B1 == ERROR_BLOCK_NUMBER || B2 == ERROR_BLOCK_NUMBER || mapsTo(*it, permutations3[p].perm[1], B2) != B1) continue;
+                Estimate.Parts++;
+                Combinations += RealType(S.getBlockSize(B0)) * S.getBlockSize(B1) * S.getBlockSize(B2) * S.getBlockSize(B3);
+                }
+            }
+        // Every combination of the four states gives up to two non-resonant and two resonant terms (see TwoParticleGFPart::addMultiterm).
+        Estimate.Terms = 4.0 * Combinations;
+        Estimate.Bytes = 2.0 * Combinations * (sizeof(TwoParticleGFPart::NonResonantTerm) + sizeof(TwoParticleGFPart::ResonantTerm));
+        TwoParticleGFs.push_back(Estimate);
+        }
+
+    Status = Computed;
+}
+
+const std::vector<Planner::BlockEstimate>& Planner::getBlocks() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return Blocks;
+}
+
+const std::vector<Planner::OperatorEstimate>& Planner::getOperators() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return Operators;
+}
+
+const std::vector<Planner::GFEstimate>& Planner::getGFs() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return GFs;
+}
+
+const std::vector<Planner::TwoParticleGFEstimate>& Planner::getTwoParticleGFs() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return TwoParticleGFs;
+}
+
+RealType Planner::getDiagonalizationFlops() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    RealType Flops = 0;
+    for (size_t i=0; i<Blocks.size(); i++) Flops += Blocks[i].Flops;
+    return Flops;
+}
+
+RealType Planner::getPeakBytes() const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    RealType Bytes = 0, Workspace = 0;
+    for (size_t i=0; i<Blocks.size(); i++) {
+        Bytes += Blocks[i].Bytes;
+        Workspace = std::max(Workspace, Blocks[i].PeakBytes - Blocks[i].Bytes);
+        }
+    for (size_t i=0; i<Operators.size(); i++) Bytes += Operators[i].Bytes;
+    for (size_t i=0; i<GFs.size(); i++) Bytes += GFs[i].Bytes;
+    for (size_t i=0; i<TwoParticleGFs.size(); i++) Bytes += TwoParticleGFs[i].Bytes;
+    return Bytes + Workspace;
+}
+
+void Planner::print(std::ostream& out) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    out << "Hamiltonian : " << Blocks.size() << " blocks, " << S.getNumberOfStates() << " states" << std::endl;
+    for (size_t i=0; i<Blocks.size(); i++)
+        out << "  block " << Blocks[i].Block << " " << Blocks[i].QN << " : size " << Blocks[i].Size
+            << ", " << format_number(Blocks[i].Flops) << " flops, "
+            << format_bytes(Blocks[i].Bytes) << " (peak " << format_bytes(Blocks[i].PeakBytes) << ")" << std::endl;
+    out << "  total : " << format_number(getDiagonalizationFlops()) << " flops" << std::endl;
+    for (size_t i=0; i<Operators.size(); i++)
+        out << "Operators c_" << Operators[i].Index << ", c^+_" << Operators[i].Index << " : " << Operators[i].Parts << " parts, "
+            << format_number(Operators[i].NonZeros) << " elements, "
+            << format_number(Operators[i].Flops) << " flops, " << format_bytes(Operators[i].Bytes) << std::endl;
+    for (size_t i=0; i<GFs.size(); i++)
+        out << "GreensFunction" << GFs[i].Indices << " : " << GFs[i].Parts << " parts, at most "
+            << format_number(GFs[i].Terms) << " terms, " << format_bytes(GFs[i].Bytes) << std::endl;
+    for (size_t i=0; i<TwoParticleGFs.size(); i++)
+        out << "TwoParticleGF" << TwoParticleGFs[i].Indices << " : " << TwoParticleGFs[i].Parts << " parts, at most "
+            << format_number(TwoParticleGFs[i].Terms) << " terms, " << format_bytes(TwoParticleGFs[i].Bytes) << std::endl;
+    out << "Peak memory : " << format_bytes(getPeakBytes()) << std::endl;
+}
+
+void Planner::printJSON(std::ostream& out) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    std::streamsize Precision = out.precision(6);
+    out << "{" << std::endl;
+    out << "  \"states\": " << S.getNumberOfStates() << "," << std::endl;
+    out << "  \"blocks\": [";
+    for (size_t i=0; i<Blocks.size(); i++) {
+        std::stringstream QN;
+        QN << Blocks[i].QN;
+        out << (i ? "," : "") << std::endl << "    {\"block\": " << Blocks[i].Block << ", \"quantum_numbers\": \"" << QN.str() << "\", \"size\": " << Blocks[i].Size
+            << ", \"flops\": " << Blocks[i].Flops << ", \"bytes\": " << Blocks[i].Bytes << ", \"peak_bytes\": " << Blocks[i].PeakBytes << "}";
+        }
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"operators\": [";
+    for (size_t i=0; i<Operators.size(); i++)
+        out << (i ? "," : "") << std::endl << "    {\"index\": " << Operators[i].Index << ", \"parts\": " << Operators[i].Parts
+            << ", \"nonzeros\": " << Operators[i].NonZeros << ", \"flops\": " << Operators[i].Flops << ", \"bytes\": " << Operators[i].Bytes << "}";
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"gf\": [";
+    for (size_t i=0; i<GFs.size(); i++)
+        out << (i ? "," : "") << std::endl << "    {\"indices\": [" << GFs[i].Indices.Index1 << ", " << GFs[i].Indices.Index2 << "], \"parts\": " << GFs[i].Parts
+            << ", \"terms\": " << GFs[i].Terms << ", \"bytes\": " << GFs[i].Bytes << "}";
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"2pgf\": [";
+    for (size_t i=0; i<TwoParticleGFs.size(); i++)
+        out << (i ? "," : "") << std::endl << "    {\"indices\": [" << TwoParticleGFs[i].Indices.Index1 << ", " << TwoParticleGFs[i].Indices.Index2 << ", "
+            << TwoParticleGFs[i].Indices.Index3 << ", " << TwoParticleGFs[i].Indices.Index4 << "], \"parts\": " << TwoParticleGFs[i].Parts
+            << ", \"terms\": " << TwoParticleGFs[i].Terms << ", \"bytes\": " << TwoParticleGFs[i].Bytes << "}";
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"diagonalization_flops\": " << getDiagonalizationFlops() << "," << std::endl;
+    out << "  \"peak_bytes\": " << getPeakBytes() << std::endl;
+    out << "}" << std::endl;
+    out.precision(Precision);
+}
+
+} // end of namespace Pomerol
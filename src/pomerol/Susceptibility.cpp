@@ -0,0 +1,108 @@
+#include "pomerol/Susceptibility.h"
+
+namespace Pomerol{
+
+Susceptibility::Susceptibility(const StatesClassification& S, const Hamiltonian& H,
+                               const FieldOperator& A, const FieldOperator& B, const DensityMatrix& DM) :
+    Thermal(DM.beta), ComputableObject(), S(S), H(H), A(A), B(B), DM(DM), Vanishing(true), Disconnected(0)
+{
+}
+
+Susceptibility::Susceptibility(const Susceptibility& Chi) :
+    Thermal(Chi.beta), ComputableObject(Chi), S(Chi.S), H(Chi.H), A(Chi.A), B(Chi.B), DM(Chi.DM), Vanishing(Chi.Vanishing),
+    Disconnected(Chi.Disconnected)
+{
+    for(std::list<SusceptibilityPart*>::const_iterator iter = Chi.parts.begin(); iter != Chi.parts.end(); iter++)
+        parts.push_back(new SusceptibilityPart(**iter));
+}
+
+Susceptibility::Susceptibility(const Susceptibility& Chi, const DensityMatrix& DM) :
+    Thermal(DM.beta), ComputableObject(), S(Chi.S), H(Chi.H), A(Chi.A), B(Chi.B), DM(DM), Vanishing(Chi.Vanishing),
+    Disconnected(0)
+{
+    if(Chi.Status<Prepared) throw (exStatusMismatch());
+    for(BlockNumber Block=0; Block<S.NumberOfBlocks(); Block++)
+        if(DM.isRetained(Block) && !Chi.DM.isRetained(Block))
+            throw std::logic_error("Susceptibility : the density matrix retains a block, which is truncated for the parts.");
+    for(std::list<SusceptibilityPart*>::const_iterator iter = Chi.parts.begin(); iter != Chi.parts.end(); iter++)
+        parts.push_back(new SusceptibilityPart(**iter, DM));
+    Status = Prepared;
+}
+
+Susceptibility::~Susceptibility()
+{
+    for(std::list<SusceptibilityPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
+        delete *iter;
+}
+
+void Susceptibility::prepare(void)
+{
+    if(Status>=Prepared) return;
+
+    // <Aleft|A|Aright><Bleft|B|Bright> with Aleft == Bright and Aright == Bleft.
+    FieldOperator::BlocksBimap const& ANontrivialBlocks = A.getBlockMapping();
+    for(FieldOperator::BlocksBimap::left_const_iterator Aiter = ANontrivialBlocks.left.begin(); Aiter != ANontrivialBlocks.left.end(); Aiter++){
+        BlockNumber Aleft = Aiter->first;
+        BlockNumber Aright = Aiter->second;
+        if(B.getLeftIndex(Aleft) != Aright) continue;
+        // check if retained blocks are included. If not, do not push.
+        if ( DM.isRetained(Aleft) || DM.isRetained(Aright) )
+            parts.push_back(new SusceptibilityPart(
+                          A.getPartFromLeftIndex(Aleft), B.getPartFromRightIndex(Aleft),
+                          H.getPart(Aright), H.getPart(Aleft),
+                          DM.getPart(Aright), DM.getPart(Aleft)));
+    }
+    if (parts.size() > 0) Vanishing = false;
+
+    Status = Prepared;
+}
+
+void Susceptibility::compute()
+{
+    if(Status>=Computed) return;
+    if(Status<Prepared) prepare();
+
+    for(std::list<SusceptibilityPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
+        (*iter)->compute();
+    Status = Computed;
+}
+
+void Susceptibility::update()
+{
+    if(Status<Prepared) throw (exStatusMismatch());
+    Status = Prepared;
+    for(std::list<SusceptibilityPart*>::iterator iter = parts.begin(); iter != parts.end(); iter++)
+        (*iter)->computeTransitions();
+    compute();
+}
+
+ComplexType Susceptibility::getAverage(const FieldOperator& O) const
+{
+    ComplexType Average = 0;
+    FieldOperator::BlocksBimap const& Blocks = O.getBlockMapping();
+    for(FieldOperator::BlocksBimap::left_const_iterator iter = Blocks.left.begin(); iter != Blocks.left.end(); iter++){
+        if(iter->first != iter->second || !DM.isRetained(iter->first)) continue;
+        RowMajorView Omatrix = O.getPartFromLeftIndex(iter->first).getRowMajorValue();
+        const DensityMatrixPart& DMpart = DM.getPart(iter->first);
+        for(RowMajorView::Index index=0; index<Omatrix.outerSize(); ++index)
+            Average += DMpart.getWeight(index) * MelemType(Omatrix.coeff(index,index));
+    }
+    return Average;
+}
+
+void Susceptibility::subtractDisconnected()
+{
+    subtractDisconnected(getAverage(A), getAverage(B));
+}
+
+void Susceptibility::subtractDisconnected(ComplexType AverageA, ComplexType AverageB)
+{
+    Disconnected = AverageA * AverageB;
+}
+
+bool Susceptibility::isVanishing(void) const
+{
+    return Vanishing;
+}
+
+} // end of namespace Pomerol
@@ -0,0 +1,115 @@
+#include "pomerol/SusceptibilityPart.h"
+
+namespace Pomerol{
+
+SusceptibilityPart::Term::Term(ComplexType Residue, RealType Pole) :
+    Residue(Residue), Pole(Pole) {};
+ComplexType SusceptibilityPart::Term::operator()(ComplexType Frequency) const { return Residue/(Frequency - Pole); }
+
+// The term is R/(exp(-beta*P) - 1) * exp(-tau*P) for 0 < tau < beta.
+ComplexType SusceptibilityPart::Term::operator()(RealType tau, RealType beta) const {
+    return Pole > 0 ? -Residue*exp(-tau*Pole)/(1 - exp(-beta*Pole)) :
+                      Residue*exp((beta-tau)*Pole)/(1 - exp(beta*Pole));
+}
+
+inline
+SusceptibilityPart::Term& SusceptibilityPart::Term::operator+=(const Term& AnotherTerm)
+{
+    Residue += AnotherTerm.Residue;
+    return *this;
+}
+
+std::ostream& operator<<(std::ostream& out, const SusceptibilityPart::Term& T)
+{
+    out << T.Residue << "/(z - " << T.Pole << ")";
+    return out;
+}
+
+SusceptibilityPart::SusceptibilityPart( const FieldOperatorPart& A, const FieldOperatorPart& B,
+                                        const HamiltonianPart& HpartInner, const HamiltonianPart& HpartOuter,
+                                        const DensityMatrixPart& DMpartInner, const DensityMatrixPart& DMpartOuter) :
+                                        Thermal(DMpartInner),
+                                        HpartInner(HpartInner), HpartOuter(HpartOuter),
+                                        DMpartInner(DMpartInner), DMpartOuter(DMpartOuter),
+                                        A(A), B(B),
+                                        Terms(Term::Compare(1e-8), Term::IsNegligible(1e-8)),
+                                        ZeroPoleWeight(0),
+                                        MatrixElementTolerance(1e-8),
+                                        ReduceResonanceTolerance(1e-8),
+                                        ReduceTolerance(1e-8)
+{}
+
+SusceptibilityPart::SusceptibilityPart(const SusceptibilityPart& Part, const DensityMatrix& DM) :
+                                        Thermal(DM),
+                                        HpartInner(Part.HpartInner), HpartOuter(Part.HpartOuter),
+                                        DMpartInner(DM.getPart(Part.HpartInner.getBlockNumber())),
+                                        DMpartOuter(DM.getPart(Part.HpartOuter.getBlockNumber())),
+                                        A(Part.A), B(Part.B),
+                                        Terms(Term::Compare(1e-8), Term::IsNegligible(1e-8)),
+                                        ZeroPoleWeight(0),
+                                        Transitions(Part.Transitions),
+                                        MatrixElementTolerance(Part.MatrixElementTolerance),
+                                        ReduceResonanceTolerance(Part.ReduceResonanceTolerance),
+                                        ReduceTolerance(Part.ReduceTolerance)
+{}
+
+void SusceptibilityPart::computeTransitions(void)
+{
+    // The weight of a zero pole grows with beta, so all non-zero matrix elements are kept.
+    Transitions.reset(new std::vector<Transition>);
+
+    // <index1|A|index2><index2|B|index1>
+    RowMajorView Amatrix = A.getRowMajorValue();
+    ColMajorView Bmatrix = B.getColMajorValue();
+    QuantumState outerSize = Amatrix.outerSize();
+
+    for(QuantumState index1=0; index1<outerSize; ++index1){
+        RowMajorView::InnerIterator Ainner(Amatrix,index1);
+        ColMajorView::InnerIterator Binner(Bmatrix,index1);
+
+        while(Ainner && Binner){
+            QuantumState A_index2 = Ainner.index();
+            QuantumState B_index2 = Binner.index();
+
+            if(A_index2 == B_index2){
+                MelemType MatrixElement = MelemType(Ainner.value()) * MelemType(Binner.value());
+                if(MatrixElement != MelemType(0))
+                    Transitions->push_back(Transition(index1, A_index2, MatrixElement,
+                                                      HpartInner.getEigenValue(A_index2) - HpartOuter.getEigenValue(index1)));
+                ++Ainner;
+                ++Binner;
+            }else{
+                // Chasing: one index runs down the other index
+                if(B_index2 < A_index2) for(;Binner && QuantumState(Binner.index())<A_index2; ++Binner);
+                else for(;Ainner && QuantumState(Ainner.index())<B_index2; ++Ainner);
+            }
+        }
+    }
+}
+
+void SusceptibilityPart::computeTerms(void)
+{
+    Terms.clear();
+    ZeroPoleWeight = 0;
+
+    for(std::vector<Transition>::const_iterator t = Transitions->begin(); t != Transitions->end(); ++t){
+        RealType Weight1 = DMpartOuter.getWeight(t->Outer);
+        if(std::abs(t->Pole) < ReduceResonanceTolerance)
+            // The integral of a constant over the imaginary time
+            ZeroPoleWeight += beta * Weight1 * t->MatrixElement;
+        else {
+            ComplexType Residue = t->MatrixElement * (DMpartInner.getWeight(t->Inner) - Weight1);
+            if(abs(Residue) > MatrixElementTolerance) Terms.add_term(Term(Residue, t->Pole));
+        };
+    }
+
+    assert(Terms.check_terms());
+}
+
+void SusceptibilityPart::compute(void)
+{
+    if(!Transitions) computeTransitions();
+    computeTerms();
+}
+
+} // end of namespace Pomerol
@@ -0,0 +1,72 @@
+#include "pomerol/TermArrays.h"
+
+#include <algorithm>
+
+namespace Pomerol {
+
+namespace {
+
+/** Orders the terms by their poles. */
+bool comparePoles(const TermArrays::Term& t1, const TermArrays::Term& t2)
+{
+    return t1.first < t2.first;
+}
+
+} // end of anonymous namespace
+
+TermArrays::TermArrays()
+{}
+
+void TermArrays::assign(std::vector<Term> Terms, RealType Tolerance)
+{
+    std::sort(Terms.begin(), Terms.end(), comparePoles);
+
+    // Merge the similar terms in place
+    size_t Size = 0;
+    for (size_t k = 0; k < Terms.size(); k++) {
+        if (Size > 0 && Terms[k].first - Terms[Size-1].first < Tolerance) Terms[Size-1].second += Terms[k].second;
+        else Terms[Size++] = Terms[k];
+        };
+
+    size_t NumberOfTerms = 0;
+    for (size_t k = 0; k < Size; k++) if (std::abs(Terms[k].second) > Tolerance) NumberOfTerms++;
+    Poles.resize(NumberOfTerms);
+    ResiduesRe.resize(NumberOfTerms);
+    ResiduesIm.resize(NumberOfTerms);
+    for (size_t k = 0, t = 0; k < Size; k++) {
+        if (std::abs(Terms[k].second) <= Tolerance) continue;
+        Poles(t) = Terms[k].first;
+        ResiduesRe(t) = real(Terms[k].second);
+        ResiduesIm(t) = imag(Terms[k].second);
+        t++;
+        };
+}
+
+size_t TermArrays::size() const
+{
+    return Poles.size();
+}
+
+RealType TermArrays::getPole(size_t k) const
+{
+    return Poles(k);
+}
+
+ComplexType TermArrays::getResidue(size_t k) const
+{
+    return ComplexType(ResiduesRe(k), ResiduesIm(k));
+}
+
+ComplexVectorType TermArrays::operator()(const ComplexVectorType& z) const
+{
+    ComplexVectorType Values = ComplexVectorType::Zero(z.size());
+    // The terms are taken in chunks, which stay in the cache while they are summed at all frequencies.
+    const long ChunkSize = 2048;
+    for (long Start = 0; Start < Poles.size(); Start += ChunkSize) {
+        long Length = std::min(ChunkSize, long(Poles.size()) - Start);
+        for (long n = 0; n < z.size(); n++) Values(n) += sum(Start, Length, z(n));
+        };
+    return Values;
+}
+
+} // end of namespace Pomerol
@@ -0,0 +1,129 @@
+#include "pomerol/Thermodynamics.h"
+
+namespace Pomerol{
+
+Thermodynamics::Thermodynamics(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H, const std::vector<RealType> &Betas) :
+    ComputableObject(), IndexInfo(IndexInfo), S(S), H(H), Betas(Betas.size()), ChargeConserved(true), SpinConserved(true)
+{
+    std::copy(Betas.begin(), Betas.end(), this->Betas.data());
+}
+
+void Thermodynamics::compute(void)
+{
+    if (Status >= Computed) return;
+    RealType GroundEnergy = H.getGroundEnergy();
+    long NBetas = Betas.size();
+
+    // Spin projections of the indices
+    ParticleIndex IndexSize = IndexInfo.getIndexSize();
+    RealVectorType IndexSz(IndexSize);
+    for (ParticleIndex i=0; i<IndexSize; ++i) IndexSz(i) = (IndexInfo.getInfo(i).Spin == up ? 0.5 : -0.5);
+
+    // Moments of the shifted energy (1, E, E^2) and of N, N^2, Sz, Sz^2, summed over all states with Boltzmann weights.
+    RealMatrixType Moments(NBetas, 3);
+    RealMatrixType BlockMoments(NBetas, 4);
+    Moments.setZero();
+    BlockMoments.setZero();
+
+    for (BlockNumber CurrentBlock=0; CurrentBlock<S.NumberOfBlocks(); CurrentBlock++) {
+        const std::vector<FockState>& states = S.getFockStates(CurrentBlock);
+        RealType N = states[0].count(), Sz = 0.0;
+        for (ParticleIndex i=0; i<IndexSize; ++i) if (states[0][i]) Sz += IndexSz(i);
+        for (size_t s=1; s<states.size() && (ChargeConserved || SpinConserved); s++) {
+            if (RealType(states[s].count()) != N) ChargeConserved = false;
+            RealType Sz_s = 0.0;
+            for (ParticleIndex i=0; i<IndexSize; ++i) if (states[s][i]) Sz_s += IndexSz(i);
+            if (std::abs(Sz_s - Sz) > std::numeric_limits<RealType>::epsilon()) SpinConserved = false;
+            };
+
+        const RealVectorType& E = H.getPart(CurrentBlock).getEigenValues();
+        if (E.size() == 0) continue;
+        RealMatrixType Powers(E.size(), 3);
+        Powers.col(0).setOnes();
+        Powers.col(1) = E.array() - GroundEnergy;
+        Powers.col(2) = Powers.col(1).array().square();
+
+        // Boltzmann weights of the block for all temperatures
+        RealMatrixType Weights = (-Betas * Powers.col(1).transpose()).array().exp().matrix();
+        RealMatrixType Contribution = Weights * Powers;
+        Moments += Contribution;
+        BlockMoments.col(0) += N * Contribution.col(0);
+        BlockMoments.col(1) += N * N * Contribution.col(0);
+        BlockMoments.col(2) += Sz * Contribution.col(0);
+        BlockMoments.col(3) += Sz * Sz * Contribution.col(0);
+        }
+
+    RealVectorType Z = Moments.col(0);
+    RealVectorType E1 = Moments.col(1).cwiseQuotient(Z);
+    RealVectorType E2 = Moments.col(2).cwiseQuotient(Z);
+
+    LogZ = Z.array().log() - Betas.array() * GroundEnergy;
+    Energy = E1.array() + GroundEnergy;
+    SpecificHeat = Betas.array().square() * (E2 - E1.cwiseAbs2()).array();
+    Entropy = Z.array().log() + Betas.array() * E1.array();
+
+    Occupancy = BlockMoments.col(0).cwiseQuotient(Z);
+    ChargeSusceptibility = Betas.array() * (BlockMoments.col(1).cwiseQuotient(Z) - Occupancy.cwiseAbs2()).array();
+    RealVectorType Magnetization = BlockMoments.col(2).cwiseQuotient(Z);
+    SpinSusceptibility = Betas.array() * (BlockMoments.col(3).cwiseQuotient(Z) - Magnetization.cwiseAbs2()).array();
+
+    Status = Computed;
+}
+
+const RealVectorType& Thermodynamics::getBetas(void) const
+{
+    return Betas;
+}
+
+const RealVectorType& Thermodynamics::getLogPartitionFunction(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return LogZ;
+}
+
+RealVectorType Thermodynamics::getFreeEnergy(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return -LogZ.cwiseQuotient(Betas);
+}
+
+const RealVectorType& Thermodynamics::getEnergy(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return Energy;
+}
+
+const RealVectorType& Thermodynamics::getSpecificHeat(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return SpecificHeat;
+}
+
+const RealVectorType& Thermodynamics::getEntropy(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    return Entropy;
+}
+
+const RealVectorType& Thermodynamics::getOccupancy(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    if (!ChargeConserved) throw (std::logic_error("Thermodynamics : the number of particles is not conserved within the blocks."));
+    return Occupancy;
+}
+
+const RealVectorType& Thermodynamics::getChargeSusceptibility(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    if (!ChargeConserved) throw (std::logic_error("Thermodynamics : the number of particles is not conserved within the blocks."));
+    return ChargeSusceptibility;
+}
+
+const RealVectorType& Thermodynamics::getSpinSusceptibility(void) const
+{
+    if (Status < Computed) throw (exStatusMismatch());
+    if (!SpinConserved) throw (std::logic_error("Thermodynamics : the projection of spin is not conserved within the blocks."));
+    return SpinSusceptibility;
+}
+
+} // end of namespace Pomerol
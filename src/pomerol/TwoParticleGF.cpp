@@ -102,6 +102,14 @@ void TwoParticleGF::prepare()
                       (*parts.rbegin())->ReduceResonanceTolerance = ReduceResonanceTolerance;
                       (*parts.rbegin())->CoefficientTolerance = CoefficientTolerance;
                       (*parts.rbegin())->MultiTermCoefficientTolerance = MultiTermCoefficientTolerance;
+
+                      // The parts of C1 and C2 are the adjoints of the creation operator parts with the swapped blocks.
+                      for(size_t k=0; k<3; ++k){
+                          const FieldOperatorPart& Part = OperatorPartAtPosition(p,k,LeftIndices[k]);
+                          if (permutations3[p].perm[k] == 2) NeededParts.insert(BlockMapping(Part.getLeftIndex(), Part.getRightIndex()));
+                          else NeededParts.insert(BlockMapping(Part.getRightIndex(), Part.getLeftIndex()));
+                          }
+                      NeededParts.insert(BlockMapping(LeftIndices[3], LeftIndices[0]));
                       }
             }
     }
@@ -112,6 +120,12 @@ void TwoParticleGF::prepare()
     Status = Prepared;
 }
 
+const BlockMappingSet& TwoParticleGF::getNeededParts(void) const
+{
+    if (Status < Prepared) throw (exStatusMismatch());
+    return NeededParts;
+}
+
 bool TwoParticleGF::isVanishing(void) const
 {
     return Vanishing;
@@ -34,6 +34,18 @@ TwoParticleGFContainer::TwoParticleGFContainer(const IndexClassification& IndexI
     MultiTermCoefficientTolerance (1e-5)//1e-5),
 {}
 
+namespace {
+
+/** The indices of the operators of a two-particle GF. */
+std::set<ParticleIndex> getOperatorIndices(const TwoParticleGF& Chi)
+{
+    std::set<ParticleIndex> Indices;
+    for (size_t k=0; k<4; k++) Indices.insert(Chi.getIndex(k));
+    return Indices;
+}
+
+} // end of anonymous namespace
+
 void TwoParticleGFContainer::prepareAll(const std::set<IndexCombination4>& InitialIndices)
 {
     fill(InitialIndices);
@@ -44,6 +56,19 @@ void TwoParticleGFContainer::prepareAll(const std::set<IndexCombination4>& Initi
         static_cast<TwoParticleGF&>(iter->second).MultiTermCoefficientTolerance = MultiTermCoefficientTolerance;
         static_cast<TwoParticleGF&>(iter->second).prepare();
        };
+    // The operators will be used in the order of the elements, see FieldOperatorContainer::hint.
+    for(std::map<IndexCombination4, boost::shared_ptr<TwoParticleGF> >::iterator iter = NonTrivialElements.begin();
+        iter != NonTrivialElements.end(); iter++)
+        Operators.hint(getOperatorIndices(*(iter->second)));
+}
+
+BlockMappingSet TwoParticleGFContainer::getNeededParts() const
+{
+    BlockMappingSet Needed;
+    for(std::map<IndexCombination4, boost::shared_ptr<TwoParticleGF> >::const_iterator iter = NonTrivialElements.begin();
+        iter != NonTrivialElements.end(); iter++)
+        Needed.insert((iter->second)->getNeededParts().begin(), (iter->second)->getNeededParts().end());
+    return Needed;
 }
 
 std::map<IndexCombination4,std::vector<ComplexType> > TwoParticleGFContainer::computeAll(bool clearTerms, std::vector<boost::tuple<ComplexType, ComplexType, ComplexType> > const& freqs, const boost::mpi::communicator & comm, bool split)
@@ -60,7 +85,13 @@ std::map<IndexCombination4,std::vector<ComplexType> > TwoParticleGFContainer::co
     for(std::map<IndexCombination4,ElementWithPermFreq<TwoParticleGF> >::iterator iter = ElementsMap.begin();
         iter != ElementsMap.end(); iter++) {
         INFO("Computing 2PGF for " << iter->first);
-        out.insert(std::make_pair(iter->first, static_cast<TwoParticleGF&>(iter->second).compute(clearTerms, freqs, comm)));
+        TwoParticleGF& chi = static_cast<TwoParticleGF&>(iter->second);
+        // The operators are acquired only for the computation of the terms.
+        std::set<ParticleIndex> Indices = getOperatorIndices(chi);
+        bool Acquire = (chi.getStatus() < TwoParticleGF::Computed);
+        if (Acquire) Operators.acquire(Indices, comm);
+        out.insert(std::make_pair(iter->first, chi.compute(clearTerms, freqs, comm)));
+        if (Acquire) Operators.release(Indices);
         };
     return out;
 }
@@ -101,7 +132,10 @@ std::map<IndexCombination4,std::vector<ComplexType> > TwoParticleGFContainer::co
         bool calc = (elem_colors[comp] == proc_colors[comm.rank()]);
         if (calc) {
             INFO("C" << elem_colors[comp] << "p" << comm.rank() << ": computing 2PGF for " << iter->first);
-            if (calc) storage[iter->first] = static_cast<TwoParticleGF&>(*(iter->second)).compute(clearTerms, freqs, comm_split);
+            std::set<ParticleIndex> Indices = getOperatorIndices(*(iter->second));
+            Operators.acquire(Indices, comm_split);
+            storage[iter->first] = static_cast<TwoParticleGF&>(*(iter->second)).compute(clearTerms, freqs, comm_split);
+            Operators.release(Indices);
             };
         };
     comm.barrier();
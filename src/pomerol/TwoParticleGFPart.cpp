@@ -3,8 +3,8 @@
 namespace Pomerol{
 
 // Make the lagging index catch up or outrun the leading index.
-inline bool chaseIndices(RowMajorMatrixType::InnerIterator& index1_iter,
-                         ColMajorMatrixType::InnerIterator& index2_iter)
+inline bool chaseIndices(RowMajorView::InnerIterator& index1_iter,
+                         ColMajorView::InnerIterator& index2_iter)
 {
     InnerQuantumState index1 = index1_iter.index();
     InnerQuantumState index2 = index2_iter.index();
@@ -92,84 +92,149 @@ void TwoParticleGFPart::compute()
     NonResonantTerms.clear();
     ResonantTerms.clear();
 
-    RealType beta = DMpart1.beta;
     // I don't have any pen now, so I'm writing here:
     // <1 | O1 | 2> <2 | O2 | 3> <3 | O3 |4> <4| CX4 |1>
     // Iterate over all values of |1><1| and |3><3|
     // Chase indices |2> and <2|, |4> and <4|.
-    const RowMajorMatrixType& O1matrix = O1.getRowMajorValue();
-    const ColMajorMatrixType& O2matrix = O2.getColMajorValue();
-    const RowMajorMatrixType& O3matrix = O3.getRowMajorValue();
-    const ColMajorMatrixType& CX4matrix = CX4.getColMajorValue();
-
-    InnerQuantumState index1;
-    InnerQuantumState index1Max = CX4matrix.outerSize(); // One can not make a cutoff in external index for evaluating 2PGF
-
-    InnerQuantumState index3;
-    InnerQuantumState index3Max = O2matrix.outerSize();
-
-    std::vector<InnerQuantumState> Index4List;
-    Index4List.reserve(index1Max*index3Max);
-
-    for(index1=0; index1<index1Max; ++index1)
-    for(index3=0; index3<index3Max; ++index3){
-        ColMajorMatrixType::InnerIterator index4bra_iter(CX4matrix,index1);
-        RowMajorMatrixType::InnerIterator index4ket_iter(O3matrix,index3);
-        Index4List.clear();
-        while (index4bra_iter && index4ket_iter){
-            if(chaseIndices(index4ket_iter,index4bra_iter)){
-                Index4List.push_back(index4bra_iter.index());
-                ++index4bra_iter;
-                ++index4ket_iter;
-            }
-        };
+    computeChains(O1.getRowMajorValue(), O2.getColMajorValue(), O3.getRowMajorValue(), CX4.getColMajorValue(), 0);
+    // The chains with truncated |1> and |3> and a retained |2> or |4>: iterate over |2><2| and |4><4|.
+    if (DMpart1.getRetainedStates().size() < Hpart1.getNumberOfEigenStates() && 
+        DMpart3.getRetainedStates().size() < Hpart3.getNumberOfEigenStates())
+        computeChains(O2.getRowMajorValue(), O3.getColMajorValue(), CX4.getRowMajorValue(), O1.getColMajorValue(), 1);
 
-        if (!Index4List.empty())
-        {
-            RealType E1 = Hpart1.getEigenValue(index1);
-            RealType E3 = Hpart3.getEigenValue(index3);
-            RealType weight1 = DMpart1.getWeight(index1);
-            RealType weight3 = DMpart3.getWeight(index3);
+    std::cout << "Total " << NonResonantTerms.size() << "+" << ResonantTerms.size() << "="
+              << NonResonantTerms.size() + ResonantTerms.size() << " terms" << std::endl << std::flush;
 
-            ColMajorMatrixType::InnerIterator index2bra_iter(O2matrix,index3);
-            RowMajorMatrixType::InnerIterator index2ket_iter(O1matrix,index1);
-            while (index2bra_iter && index2ket_iter){
-                if (chaseIndices(index2ket_iter,index2bra_iter)){
+    assert(NonResonantTerms.check_terms());
+    assert(ResonantTerms.check_terms());
 
-                    InnerQuantumState index2 = index2ket_iter.index();
-                    RealType E2 = Hpart2.getEigenValue(index2);
-                    RealType weight2 = DMpart2.getWeight(index2);
+    Status = Computed;
+}
 
-                    for (unsigned long p4 = 0; p4 < Index4List.size(); ++p4)
+void TwoParticleGFPart::computeChains(const RowMajorView& A, const ColMajorView& B, const RowMajorView& C, const ColMajorView& D, int Shift)
+{
+    RealType beta = DMpart1.beta;
+    // The states a, b, c and d of the chain are the states Shift+1, Shift+2, ... of the part.
+    const HamiltonianPart* Hparts[4] = {&Hpart1, &Hpart2, &Hpart3, &Hpart4};
+    const DensityMatrixPart* DMparts[4] = {&DMpart1, &DMpart2, &DMpart3, &DMpart4};
+    const HamiltonianPart &Ha = *Hparts[Shift], &Hb = *Hparts[(Shift+1)%4], &Hc = *Hparts[(Shift+2)%4], &Hd = *Hparts[(Shift+3)%4];
+    const DensityMatrixPart &DMa = *DMparts[Shift], &DMb = *DMparts[(Shift+1)%4], &DMc = *DMparts[(Shift+2)%4], &DMd = *DMparts[(Shift+3)%4];
+    bool Rotated = (Shift != 0);
+    // The energies and the weights of the states 1, 2, 3, 4
+    RealType E[4], W[4];
+
+    InnerQuantumState a;
+    InnerQuantumState aMax = D.outerSize(); // One can not make a cutoff in external index for evaluating 2PGF
+
+    InnerQuantumState cMax = B.outerSize();
+    std::vector<InnerQuantumState> AllC(cMax);
+    for (InnerQuantumState c=0; c<cMax; ++c) AllC[c] = c;
+    const std::vector<InnerQuantumState>& RetainedC = DMc.getRetainedStates();
+
+    std::vector<InnerQuantumState> DList;
+    DList.reserve(D.innerSize());
+
+    if (A.isDense() && B.isDense() && C.isDense() && D.isDense()) {
+        // All matrix elements are stored in the columns, so the products <a|A|b><b|B|c> and <c|C|d><d|D|a> 
+        // for a given pair of a and c are products of contiguous vectors.
+        ColMajorDenseMatrixType AT = A.dense().transpose();   // b x a
+        ColMajorDenseMatrixType Bdense = B.dense();           // b x c
+        ColMajorDenseMatrixType CT = C.dense().transpose();   // d x c
+        ColMajorDenseMatrixType Ddense = D.dense();           // d x a
+        VectorType ProductsB, ProductsD;
+
+        for(a=0; a<aMax; ++a){
+            const std::vector<InnerQuantumState>& CList = (DMa.isRetained(a) ? AllC : RetainedC);
+            for(std::vector<InnerQuantumState>::const_iterator c = CList.begin(); c != CList.end(); ++c){
+                ProductsD.noalias() = CT.col(*c).cwiseProduct(Ddense.col(a));
+                DList.clear();
+                for (InnerQuantumState d=0; d<InnerQuantumState(ProductsD.size()); ++d)
+                    if (ProductsD(d) != MelemType(0) && !(Rotated && DMd.isRetained(d))) DList.push_back(d);
+                if (DList.empty()) continue;
+
+                E[Shift] = Ha.getEigenValue(a);
+                E[(Shift+2)%4] = Hc.getEigenValue(*c);
+                W[Shift] = DMa.getWeight(a);
+                W[(Shift+2)%4] = DMc.getWeight(*c);
+
+                ProductsB.noalias() = AT.col(a).cwiseProduct(Bdense.col(*c));
+                for (InnerQuantumState b=0; b<InnerQuantumState(ProductsB.size()); ++b){
+                    if (ProductsB(b) == MelemType(0) || (Rotated && DMb.isRetained(b))) continue;
+                    E[(Shift+1)%4] = Hb.getEigenValue(b);
+                    W[(Shift+1)%4] = DMb.getWeight(b);
+
+                    for (unsigned long pd = 0; pd < DList.size(); ++pd)
                     {
-                        InnerQuantumState index4 = Index4List[p4];//*pIndex4;
-                        RealType E4 = Hpart4.getEigenValue(index4);
-                        RealType weight4 = DMpart4.getWeight(index4);
-                        if (weight1 + weight2 + weight3 + weight4 >= CoefficientTolerance) {
-                            ComplexType MatrixElement = index2ket_iter.value()*
-                                                        index2bra_iter.value()*
-                                                        O3matrix.coeff(index3,index4)*
-                                                        CX4matrix.coeff(index4,index1);
-
+                        InnerQuantumState d = DList[pd];
+                        E[(Shift+3)%4] = Hd.getEigenValue(d);
+                        W[(Shift+3)%4] = DMd.getWeight(d);
+                        if (W[0] + W[1] + W[2] + W[3] >= CoefficientTolerance) {
+                            ComplexType MatrixElement = ProductsB(b)*ProductsD(d);
                             MatrixElement *= Permutation.sign;
-
-                            addMultiterm(MatrixElement,beta,E1,E2,E3,E4,weight1,weight2,weight3,weight4);
+                            addMultiterm(MatrixElement,beta,E[0],E[1],E[2],E[3],W[0],W[1],W[2],W[3]);
                         }
                     }
-                    ++index2bra_iter;
-                    ++index2ket_iter;
-                };
+                }
             }
-        };
+        }
+        return;
     }
 
-    std::cout << "Total " << NonResonantTerms.size() << "+" << ResonantTerms.size() << "="
-              << NonResonantTerms.size() + ResonantTerms.size() << " terms" << std::endl << std::flush;
-
-    assert(NonResonantTerms.check_terms());
-    assert(ResonantTerms.check_terms());
-
-    Status = Computed;
+    for(a=0; a<aMax; ++a){
+        const std::vector<InnerQuantumState>& CList = (DMa.isRetained(a) ? AllC : RetainedC);
+        for(std::vector<InnerQuantumState>::const_iterator c = CList.begin(); c != CList.end(); ++c){
+            ColMajorView::InnerIterator d_bra_iter(D,a);
+            RowMajorView::InnerIterator d_ket_iter(C,*c);
+            DList.clear();
+            while (d_bra_iter && d_ket_iter){
+                if(chaseIndices(d_ket_iter,d_bra_iter)){
+                    if (!(Rotated && DMd.isRetained(d_bra_iter.index()))) DList.push_back(d_bra_iter.index());
+                    ++d_bra_iter;
+                    ++d_ket_iter;
+                }
+            };
+
+            if (!DList.empty())
+            {
+                E[Shift] = Ha.getEigenValue(a);
+                E[(Shift+2)%4] = Hc.getEigenValue(*c);
+                W[Shift] = DMa.getWeight(a);
+                W[(Shift+2)%4] = DMc.getWeight(*c);
+
+                ColMajorView::InnerIterator b_bra_iter(B,*c);
+                RowMajorView::InnerIterator b_ket_iter(A,a);
+                while (b_bra_iter && b_ket_iter){
+                    if (chaseIndices(b_ket_iter,b_bra_iter)){
+
+                        InnerQuantumState b = b_ket_iter.index();
+                        if (!(Rotated && DMb.isRetained(b))) {
+                            E[(Shift+1)%4] = Hb.getEigenValue(b);
+                            W[(Shift+1)%4] = DMb.getWeight(b);
+
+                            for (unsigned long pd = 0; pd < DList.size(); ++pd)
+                            {
+                                InnerQuantumState d = DList[pd];
+                                E[(Shift+3)%4] = Hd.getEigenValue(d);
+                                W[(Shift+3)%4] = DMd.getWeight(d);
+                                if (W[0] + W[1] + W[2] + W[3] >= CoefficientTolerance) {
+                                    ComplexType MatrixElement = MelemType(b_ket_iter.value())*
+                                                                MelemType(b_bra_iter.value())*
+                                                                MelemType(C.coeff(*c,d))*
+                                                                MelemType(D.coeff(d,a));
+
+                                    MatrixElement *= Permutation.sign;
+
+                                    addMultiterm(MatrixElement,beta,E[0],E[1],E[2],E[3],W[0],W[1],W[2],W[3]);
+                                }
+                            }
+                        }
+                        ++b_bra_iter;
+                        ++b_ket_iter;
+                    };
+                }
+            };
+        }
+    }
 }
 
 inline
@@ -116,8 +116,13 @@ bool run_test(ComplexType J /* spin-flip amplitude */) {
         GF.prepare();
         GF.compute();
 
+        #ifdef POMEROL_FLOAT_STORAGE
+        RealType tolerance = 1e-6;
+        #else
+        RealType tolerance = 1e-10;
+        #endif
         for (int n=0; n<10; ++n)
-            if(std::abs(GF(n) - ref(s1,s2,n)) > 1e-10) return false;
+            if(std::abs(GF(n) - ref(s1,s2,n)) > tolerance) return false;
     }}
     return true;
 }
@@ -0,0 +1,142 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/DensityMatrixCorrelationsTest.cpp
+** \brief Test of the one-body and the two-body density matrices.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperator.h"
+#include "DensityMatrix.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+bool compare(ComplexType a, ComplexType b)
+{
+    return abs(a-b) < 1e-6;
+}
+
+/** The thermal average of an operator from the parts of its matrix in the eigenbasis, which map a block to itself. */
+ComplexType getAverage(const IndexClassification &IndexInfo, const StatesClassification &S, const Hamiltonian &H,
+                       const DensityMatrix &rho, const Operator &O)
+{
+    QuadraticOperator Q(IndexInfo, S, H, O);
+    Q.prepare();
+    Q.compute();
+    ComplexType Average = 0;
+    FieldOperator::BlocksBimap const& Blocks = Q.getBlockMapping();
+    for(FieldOperator::BlocksBimap::left_const_iterator iter = Blocks.left.begin(); iter != Blocks.left.end(); iter++){
+        if(iter->first != iter->second) continue;
+        RowMajorView Omatrix = Q.getPartFromLeftIndex(iter->first).getRowMajorValue();
+        for(RowMajorView::Index index=0; index<Omatrix.outerSize(); ++index)
+            Average += rho.getPart(iter->first).getWeight(index) * MelemType(Omatrix.coeff(index,index));
+    }
+    return Average;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    RealType U = 2.0, mu = 0.7, beta = 4.0;
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "C", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+    LatticePresets::addHopping(&L, "B","C", -0.5);
+    LatticePresets::addMagnetization(&L, "C", 0.3);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    // <c^+_i c_j> of all pairs
+    ParticleIndex N = IndexInfo.getIndexSize();
+    MatrixType OneBody = rho.getOneBodyDensityMatrix();
+    if (OneBody.rows() != N || OneBody.cols() != N) return EXIT_FAILURE;
+    for (ParticleIndex i=0; i<N; i++)
+        for (ParticleIndex j=0; j<N; j++) {
+            Operator O = OperatorPresets::c_dag(i);
+            O *= OperatorPresets::c(j);
+            ComplexType Reference = getAverage(IndexInfo, S, H, rho, O);
+            INFO("<c^+_" << i << " c_" << j << "> = " << OneBody(i,j) << " == " << Reference);
+            if (!compare(OneBody(i,j), Reference)) return EXIT_FAILURE;
+            };
+    for (ParticleIndex i=0; i<N; i++)
+        if (!compare(OneBody(i,i), rho.getAverageOccupancy(i))) return EXIT_FAILURE;
+
+    // <c^+_i c^+_j c_l c_k> of a few pairs
+    std::vector<IndexCombination2> Pairs;
+    Pairs.push_back(IndexCombination2(0,1));
+    Pairs.push_back(IndexCombination2(1,0));
+    Pairs.push_back(IndexCombination2(0,3));
+    Pairs.push_back(IndexCombination2(1,4));
+    Pairs.push_back(IndexCombination2(2,5));
+    Pairs.push_back(IndexCombination2(4,1));
+    MatrixType TwoBody = rho.getTwoBodyDensityMatrix(Pairs);
+    if (TwoBody.rows() != ParticleIndex(Pairs.size()) || TwoBody.cols() != ParticleIndex(Pairs.size())) return EXIT_FAILURE;
+    for (size_t p=0; p<Pairs.size(); p++)
+        for (size_t q=0; q<Pairs.size(); q++) {
+            Operator O = OperatorPresets::c_dag(Pairs[p].Index1);
+            O *= OperatorPresets::c_dag(Pairs[p].Index2);
+            O *= OperatorPresets::c(Pairs[q].Index2);
+            O *= OperatorPresets::c(Pairs[q].Index1);
+            ComplexType Reference = getAverage(IndexInfo, S, H, rho, O);
+            INFO("<c^+_" << Pairs[p].Index1 << " c^+_" << Pairs[p].Index2 << " c_" << Pairs[q].Index2 << " c_" << Pairs[q].Index1 << "> = "
+                 << TwoBody(p,q) << " == " << Reference);
+            if (!compare(TwoBody(p,q), Reference)) return EXIT_FAILURE;
+            };
+    // <c^+_i c^+_j c_j c_i> = <n_i n_j>
+    if (!compare(TwoBody(0,0), rho.getAverageDoubleOccupancy(0,1))) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
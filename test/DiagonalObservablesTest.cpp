@@ -0,0 +1,127 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/DiagonalObservablesTest.cpp
+** \brief Test of the thermal averages of several operators, which are diagonal in the FockState basis, measured together.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "DensityMatrix.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+bool compare(RealType a, RealType b)
+{
+    return std::abs(a-b) < 1e-6;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    RealType U = 2.0, mu = 0.7, beta = 4.0;
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "C", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+    LatticePresets::addHopping(&L, "B","C", -0.5);
+    LatticePresets::addMagnetization(&L, "C", 0.3);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    // All n_i and n_i n_j, the total occupancy and the Sz correlators of the sites
+    ParticleIndex N = IndexInfo.getIndexSize();
+    std::vector<DiagonalObservable> Observables;
+    for (ParticleIndex i=0; i<N; i++) Observables.push_back(DiagonalObservable::Occupancy(i));
+    for (ParticleIndex i=0; i<N; i++)
+        for (ParticleIndex j=0; j<N; j++) Observables.push_back(DiagonalObservable::DoubleOccupancy(i,j));
+    DiagonalObservable Total;
+    for (ParticleIndex i=0; i<N; i++) Total += DiagonalObservable::Occupancy(i);
+    Observables.push_back(Total);
+    const char* Sites[3] = {"A","B","C"};
+    for (int a=0; a<3; a++)
+        for (int b=0; b<3; b++)
+            Observables.push_back(DiagonalObservable::SzSz(IndexInfo.getIndex(Sites[a],0,up), IndexInfo.getIndex(Sites[a],0,down),
+                                                           IndexInfo.getIndex(Sites[b],0,up), IndexInfo.getIndex(Sites[b],0,down)));
+
+    std::vector<RealType> Averages = rho.getAverages(Observables);
+    if (Averages.size() != Observables.size()) return EXIT_FAILURE;
+
+    size_t k = 0;
+    for (ParticleIndex i=0; i<N; i++, k++) {
+        INFO("<n_" << i << "> = " << Averages[k] << " == " << rho.getAverageOccupancy(i));
+        if (!compare(Averages[k], rho.getAverageOccupancy(i))) return EXIT_FAILURE;
+        };
+    for (ParticleIndex i=0; i<N; i++)
+        for (ParticleIndex j=0; j<N; j++, k++) {
+            if (!compare(Averages[k], rho.getAverageDoubleOccupancy(i,j))) return EXIT_FAILURE;
+            // n_i n_i = n_i
+            if (i == j && !compare(Averages[k], rho.getAverageOccupancy(i))) return EXIT_FAILURE;
+            };
+    INFO("<N> = " << Averages[k] << " == " << rho.getAverageOccupancy());
+    if (!compare(Averages[k++], rho.getAverageOccupancy())) return EXIT_FAILURE;
+    for (int a=0; a<3; a++)
+        for (int b=0; b<3; b++, k++) {
+            ParticleIndex ua = IndexInfo.getIndex(Sites[a],0,up), da = IndexInfo.getIndex(Sites[a],0,down);
+            ParticleIndex ub = IndexInfo.getIndex(Sites[b],0,up), db = IndexInfo.getIndex(Sites[b],0,down);
+            RealType SzSz = 0.25*(rho.getAverageDoubleOccupancy(ua,ub) - rho.getAverageDoubleOccupancy(ua,db) 
+                                - rho.getAverageDoubleOccupancy(da,ub) + rho.getAverageDoubleOccupancy(da,db));
+            INFO("<Sz_" << Sites[a] << " Sz_" << Sites[b] << "> = " << Averages[k] << " == " << SzSz);
+            if (!compare(Averages[k], SzSz)) return EXIT_FAILURE;
+            };
+
+    return EXIT_SUCCESS;
+}
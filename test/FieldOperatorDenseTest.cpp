@@ -0,0 +1,133 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/FieldOperatorDenseTest.cpp
+** \brief Test of the Green's functions calculated with the dense and the sparse storage of the field operators.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "TwoParticleGF.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 1.0;
+RealType mu = 0.4;
+RealType beta = 10.0;
+
+/** Compute the operators with a given fill ratio of the dense storage, then G_{00} and chi_{0101} at a few frequencies. 
+ * Returns the number of the dense parts of c^+_0 or 0 if c_0 is not stored as c^+_0. */
+size_t computeValues(IndexClassification &IndexInfo, StatesClassification &S, const Hamiltonian &H, const DensityMatrix &rho,
+                     RealType Ratio, std::vector<ComplexType> &Values)
+{
+    FieldOperatorPart::DenseFillRatio = Ratio;
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+
+    const CreationOperator &CX0 = Operators.getCreationOperator(0);
+    const AnnihilationOperator &C0 = Operators.getAnnihilationOperator(0);
+    size_t DenseParts = 0;
+    FieldOperator::BlocksBimap Map = CX0.getBlockMapping();
+    for (FieldOperator::BlocksBimap::right_const_iterator it=Map.right.begin(); it!=Map.right.end(); it++) {
+        DenseParts += CX0.getPartFromRightIndex(it->first).isDense();
+        // c_0 views the storage of c^+_0
+        if (CX0.getPartFromRightIndex(it->first).isDense() != C0.getPartFromRightIndex(it->second).isDense()) return 0;
+        };
+
+    GreensFunction GF(S,H,C0,CX0,rho);
+    GF.prepare();
+    GF.compute();
+    Values.clear();
+    for (int n=0; n<10; n++) Values.push_back(GF(n));
+
+    TwoParticleGF Chi(S,H,C0,Operators.getAnnihilationOperator(1),CX0,Operators.getCreationOperator(1),rho);
+    Chi.prepare();
+    Chi.compute();
+    for (int n=-2; n<2; n++) {
+        Values.push_back(Chi(n,n,n));
+        Values.push_back(Chi(n,n+1,n-1));
+        };
+    return DenseParts;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+    // A decoupled site makes some parts of the operators sparse.
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "C", U, -mu);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    std::vector<ComplexType> Sparse, Dense, Mixed;
+    size_t SparseParts = computeValues(IndexInfo, S, H, rho, 2.0, Sparse);
+    size_t DenseParts = computeValues(IndexInfo, S, H, rho, 0.0, Dense);
+    size_t MixedParts = computeValues(IndexInfo, S, H, rho, 0.5, Mixed);
+    INFO("Dense parts of c^+_0 : " << SparseParts << " " << DenseParts << " " << MixedParts);
+    if (SparseParts != 0 || DenseParts == 0 || MixedParts == 0 || MixedParts == DenseParts) return EXIT_FAILURE;
+
+    for (size_t i=0; i<Sparse.size(); i++) {
+        INFO(Sparse[i] << " == " << Dense[i] << " == " << Mixed[i]);
+        if (abs(Sparse[i] - Dense[i]) > 1e-8 * (1.0 + abs(Sparse[i])) || abs(Sparse[i] - Mixed[i]) > 1e-8 * (1.0 + abs(Sparse[i]))) return EXIT_FAILURE;
+        };
+
+    return EXIT_SUCCESS;
+}
@@ -99,7 +99,7 @@ int main(int argc, char* argv[])
     cmatrix.coeffRef(0,3) = 0.21023036;
     cmatrix.coeffRef(1,3) = -0.67513198;
 
-    ColMajorMatrixType cmatrix_result=Cdag1.getColMajorValue();
+    ColMajorMatrixType cmatrix_result=Cdag1.getColMajorValue().eval();
     INFO(cmatrix_result);
     INFO(cmatrix);
     # warning no good test condition for eigenfuctions defined with an arbitrary phase.
@@ -112,7 +112,7 @@ int main(int argc, char* argv[])
     C1.compute(); // makes nothing
     C2.compute(); 
     
-    if ( std::abs ((C1.getRowMajorValue() - C2.getRowMajorValue()).sum()) > 1e-6) return EXIT_FAILURE;
+    if ( std::abs ((C1.getRowMajorValue().eval() - C2.getRowMajorValue().eval()).sum()) > 1e-6) return EXIT_FAILURE;
 
     return EXIT_SUCCESS;
 }
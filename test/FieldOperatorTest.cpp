@@ -82,7 +82,7 @@ int main(int argc, char* argv[])
     
     DEBUG(C.getParts()[1]->getColMajorValue());
 
-    DEBUG((C.getParts()[1]->getColMajorValue().transpose() - Cdag.getParts()[1]->getRowMajorValue()).norm());
+    DEBUG((C.getParts()[1]->getColMajorValue().eval().transpose() - Cdag.getParts()[1]->getRowMajorValue().eval()).norm());
     return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,168 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/FieldOperatorTruncationTest.cpp
+** \brief Test of the field operators computed only for the parts, which are used by the Green's functions with a truncated density matrix.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "TwoParticleGF.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 1.0;
+RealType mu = 0.4;
+RealType beta = 100.0;
+
+/** Compute G_{00} and chi_{0101} at a few frequencies. */
+void computeValues(const StatesClassification &S, const Hamiltonian &H, const DensityMatrix &rho, 
+                   GreensFunction &GF, TwoParticleGF &Chi, std::vector<ComplexType> &Values)
+{
+    GF.prepare();
+    GF.compute();
+    Values.clear();
+    for (int n=0; n<10; n++) Values.push_back(GF(n));
+
+    Chi.prepare();
+    Chi.compute();
+    for (int n=-2; n<2; n++) {
+        Values.push_back(Chi(n,n,n));
+        Values.push_back(Chi(n,n+1,n-1));
+        };
+}
+
+/** Returns the number of the computed parts of a creation operator. */
+size_t countComputed(const CreationOperator &CX)
+{
+    size_t Computed = 0;
+    FieldOperator::BlocksBimap Map = CX.getBlockMapping();
+    for (FieldOperator::BlocksBimap::right_const_iterator it=Map.right.begin(); it!=Map.right.end(); it++)
+        Computed += (CX.getPartFromRightIndex(it->first).getStatus() == ComputableObject::Computed);
+    return Computed;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "C", U, -mu);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+    rho.truncateBlocks(1e-6);
+    size_t Retained = 0;
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++) Retained += rho.isRetained(b);
+    INFO("Retained blocks : " << Retained << " of " << S.NumberOfBlocks());
+    if (Retained == 0 || Retained == S.NumberOfBlocks()) return EXIT_FAILURE;
+
+    // All parts of the operators
+    std::vector<ComplexType> Full;
+    FieldOperatorContainer FullOperators(IndexInfo, S, H);
+    FullOperators.prepareAll();
+    FullOperators.computeAll();
+    GreensFunction FullGF(S,H,FullOperators.getAnnihilationOperator(0),FullOperators.getCreationOperator(0),rho);
+    TwoParticleGF FullChi(S,H,FullOperators.getAnnihilationOperator(0),FullOperators.getAnnihilationOperator(1),
+                          FullOperators.getCreationOperator(0),FullOperators.getCreationOperator(1),rho);
+    computeValues(S, H, rho, FullGF, FullChi, Full);
+
+    // The parts used by the Green's functions, which are found in their prepare phase
+    std::vector<ComplexType> Needed;
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    GreensFunction GF(S,H,Operators.getAnnihilationOperator(0),Operators.getCreationOperator(0),rho);
+    TwoParticleGF Chi(S,H,Operators.getAnnihilationOperator(0),Operators.getAnnihilationOperator(1),
+                      Operators.getCreationOperator(0),Operators.getCreationOperator(1),rho);
+    GF.prepare();
+    Chi.prepare();
+    BlockMappingSet NeededParts = GF.getNeededParts();
+    NeededParts.insert(Chi.getNeededParts().begin(), Chi.getNeededParts().end());
+    Operators.computeAll(NeededParts);
+    computeValues(S, H, rho, GF, Chi, Needed);
+
+    // The parts of the Green's function only, which have a retained block.
+    // The eigenvectors of the other blocks are released before the operators are computed.
+    std::vector<ComplexType> Retained1;
+    FieldOperatorContainer GFOperators(IndexInfo, S, H);
+    GFOperators.prepareAll();
+    BlockMappingSet RetainedParts = GFOperators.getRetainedParts(rho);
+    std::set<BlockNumber> Unused = GFOperators.getUnusedBlocks(RetainedParts);
+    INFO("Unused blocks : " << Unused.size());
+    if (Unused.empty()) return EXIT_FAILURE;
+    H.releaseEigenvectors(Unused);
+    GFOperators.computeAll(RetainedParts);
+    GreensFunction GF1(S,H,GFOperators.getAnnihilationOperator(0),GFOperators.getCreationOperator(0),rho);
+    GF1.prepare();
+    GF1.compute();
+    for (int n=0; n<10; n++) Retained1.push_back(GF1(n));
+
+    size_t FullCount = countComputed(FullOperators.getCreationOperator(0));
+    size_t NeededCount = countComputed(Operators.getCreationOperator(0));
+    size_t RetainedCount = countComputed(GFOperators.getCreationOperator(0));
+    INFO("Computed parts of c^+_0 : " << FullCount << " " << NeededCount << " " << RetainedCount);
+    if (NeededCount >= FullCount || RetainedCount >= FullCount) return EXIT_FAILURE;
+
+    for (size_t i=0; i<Full.size(); i++) {
+        INFO(Full[i] << " == " << Needed[i]);
+        if (abs(Full[i] - Needed[i]) > 1e-8 * (1.0 + abs(Full[i]))) return EXIT_FAILURE;
+        if (i < Retained1.size() && abs(Full[i] - Retained1[i]) > 1e-8 * (1.0 + abs(Full[i]))) return EXIT_FAILURE;
+        };
+
+    return EXIT_SUCCESS;
+}
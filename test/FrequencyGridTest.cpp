@@ -0,0 +1,137 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/FrequencyGridTest.cpp
+** \brief Test of the grids of frequencies and of the evaluation of the Green's functions on them.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "FrequencyGrid.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType mu = 0.7;
+RealType beta = 10.0;
+
+bool compare(ComplexType a, ComplexType b)
+{
+    return abs(a-b) < 1e-10 * (1.0 + abs(a));
+}
+
+/** Compares the values of the components on a grid with the values of the Green's functions at single frequencies. */
+bool checkGrid(GFContainer& G, const FrequencyGrid& Grid, const std::vector<IndexCombination2>& Indices)
+{
+    ComplexMatrixType Values = G.evaluate(Grid, Indices);
+    if (Values.rows() != long(Indices.size()) || Values.cols() != Grid.size()) return false;
+    for (size_t c=0; c<Indices.size(); c++)
+        for (long n=0; n<Grid.size(); n++)
+            if (!compare(Values(c,n), G(Indices[c])(Grid.getPoint(n)))) {
+                ERROR("G" << Indices[c] << "(" << Grid.getPoint(n) << ") = " << Values(c,n) << " != " << G(Indices[c])(Grid.getPoint(n)));
+                return false;
+                };
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    // Grids
+    FermionicMatsubaraGrid Fermionic(beta, -3, 5);
+    if (Fermionic.size() != 8 || Fermionic.getPoint(0) != ComplexType(0, -5*M_PI/beta)) return EXIT_FAILURE;
+    if (Fermionic.getConjugate(0) != 5 || Fermionic.getConjugate(3) != 2 || Fermionic.getConjugate(6) != -1) return EXIT_FAILURE;
+    BosonicMatsubaraGrid Bosonic(beta, -2, 3);
+    if (Bosonic.size() != 5 || !compare(Bosonic.getPoint(4), ComplexType(0, 4*M_PI/beta))) return EXIT_FAILURE;
+    if (Bosonic.getConjugate(2) != 2 || Bosonic.getConjugate(0) != 4) return EXIT_FAILURE;
+    RealFrequencyGrid Real(-4.0, 4.0, 401, 0.05);
+    if (Real.size() != 401 || Real.getPoint(400) != ComplexType(4.0, 0.05) || Real.getConjugate(7) != -1) return EXIT_FAILURE;
+    ComplexVectorType Points(3);
+    Points << ComplexType(1.0, 0.5), ComplexType(0.0, 2.0), ComplexType(1.0, -0.5);
+    FrequencyGrid Arbitrary(Points);
+    if (Arbitrary.getConjugate(0) != 2 || Arbitrary.getConjugate(1) != -1) return EXIT_FAILURE;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+    GFContainer G(IndexInfo,S,H,rho,Operators);
+    G.prepareAll();
+    G.computeAll();
+
+    // All components, the conjugate points are taken from the transposed components
+    std::vector<IndexCombination2> All;
+    for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); i++)
+        for (ParticleIndex j=0; j<IndexInfo.getIndexSize(); j++)
+            All.push_back(IndexCombination2(i,j));
+    if (!checkGrid(G, FermionicMatsubaraGrid(beta, -600, 600), All)) return EXIT_FAILURE;
+    if (!checkGrid(G, FermionicMatsubaraGrid(beta, -3, 5), All)) return EXIT_FAILURE;
+    if (!checkGrid(G, Real, All)) return EXIT_FAILURE;
+    if (!checkGrid(G, Arbitrary, All)) return EXIT_FAILURE;
+
+    // Components without the transposed ones are evaluated at all points
+    std::vector<IndexCombination2> Upper;
+    Upper.push_back(IndexCombination2(0,1));
+    Upper.push_back(IndexCombination2(0,2));
+    Upper.push_back(IndexCombination2(1,1));
+    if (!checkGrid(G, FermionicMatsubaraGrid(beta, -600, 600), Upper)) return EXIT_FAILURE;
+    if (!checkGrid(G, Bosonic, Upper)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/GFUpdateTest.cpp
+** \brief Test of the update of the Green's function between the iterations of a self-consistency loop.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType beta = 10.0;
+
+void fill_lattice(Lattice &L, RealType V, RealType eps)
+{
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B1",1,2));
+    L.addSite(new Lattice::Site("B2",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -U/2);
+    LatticePresets::addLevel(&L, "B1", eps);
+    LatticePresets::addLevel(&L, "B2", -eps);
+    LatticePresets::addHopping(&L, "A", "B1", V);
+    LatticePresets::addHopping(&L, "A", "B2", V);
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    fill_lattice(L, 0.5, 0.3);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare(world);
+    H.compute(world);
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+    GFContainer G(IndexInfo,S,H,rho,Operators);
+    std::set<IndexCombination2> indices;
+    ParticleIndex d0 = IndexInfo.getIndex("A",0,down);
+    indices.insert(IndexCombination2(d0,d0));
+    G.prepareAll(indices);
+    G.computeAll();
+
+    // Next iterations : new bath parameters, everything except the values is kept.
+    for (int iteration=1; iteration<=3; iteration++) {
+        Lattice L2;
+        fill_lattice(L2, 0.5 + 0.01*iteration, 0.3 - 0.02*iteration);
+        IndexHamiltonian Storage2(&L2,IndexInfo);
+        Storage2.prepare();
+
+        H.update(Storage2, true, world);
+        H.compute(world);
+        rho.update();
+        Operators.updateAll();
+        G.updateAll();
+
+        // Reference : the same iteration from scratch
+        Hamiltonian H2(IndexInfo, Storage2, S);
+        H2.prepare(world);
+        H2.compute(world);
+        DensityMatrix rho2(S,H2,beta);
+        rho2.prepare();
+        rho2.compute();
+        FieldOperatorContainer Operators2(IndexInfo, S, H2);
+        Operators2.prepareAll();
+        Operators2.computeAll();
+        GFContainer G2(IndexInfo,S,H2,rho2,Operators2);
+        G2.prepareAll(indices);
+        G2.computeAll();
+
+        for(int n = -100; n<100; ++n) {
+            ComplexType g = G(d0,d0)(n), g2 = G2(d0,d0)(n);
+            if (std::abs(g - g2) > 1e-10) { 
+                ERROR("Iteration " << iteration << ", G(" << n << ") = " << g << " != " << g2);
+                return EXIT_FAILURE;
+                };
+            }
+        INFO("Iteration " << iteration << " : G(0) = " << G(d0,d0)(0));
+    }
+
+    return EXIT_SUCCESS;
+}
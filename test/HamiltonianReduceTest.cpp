@@ -0,0 +1,138 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/HamiltonianReduceTest.cpp
+** \brief Test of the calculation in the eigenbasis truncated by Hamiltonian::reduce.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "TwoParticleGFContainer.h"
+
+using namespace Pomerol;
+
+RealType beta = 20.0;
+
+/** Runs the pipeline up to the two-particle GF in the eigenbasis reduced by Cutoff and returns G(0) and Chi(0,0,0). */
+bool run(IndexClassification &IndexInfo, IndexHamiltonian &Storage, StatesClassification &S, 
+         const Hamiltonian &HFull, RealType Cutoff, ComplexType &G0, ComplexType &Chi0, RealType &E)
+{
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute();
+    H.reduce(Cutoff);
+
+    // The retained eigenstates are the lowest eigenstates of the full problem
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++) {
+        const HamiltonianPart &Part = H.getPart(b), &PartFull = HFull.getPart(b);
+        InnerQuantumState n = Part.getNumberOfEigenStates();
+        if (Part.getMatrix().rows() != (long)S.getBlockSize(b) || Part.getMatrix().cols() != (long)n) return false;
+        for (InnerQuantumState i=0; i<PartFull.getNumberOfEigenStates(); i++)
+            if ((i < n) != (PartFull.getEigenValue(i) <= HFull.getGroundEnergy() + Cutoff)) return false;
+        if (n == 0) continue;
+        if ((Part.getEigenValues() - PartFull.getEigenValues().head(n)).cwiseAbs().maxCoeff() > 1e-14) return false;
+        if ((Part.getMatrix() - PartFull.getMatrix().leftCols(n)).cwiseAbs().maxCoeff() > 1e-14) return false;
+        }
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+    E = rho.getAverageEnergy();
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+
+    GFContainer G(IndexInfo,S,H,rho,Operators);
+    std::set<IndexCombination2> indices2;
+    indices2.insert(IndexCombination2(0,0));
+    G.prepareAll(indices2);
+    G.computeAll();
+    G0 = G(0,0)(0);
+
+    TwoParticleGFContainer Chi(IndexInfo,S,H,rho,Operators);
+    std::set<IndexCombination4> indices4;
+    indices4.insert(IndexCombination4(0,1,0,1));
+    Chi.prepareAll(indices4);
+    Chi.computeAll();
+    Chi0 = Chi(IndexCombination4(0,1,0,1))(0,0,0);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "A", 4.0, -2.0);
+    LatticePresets::addCoulombS(&L, "B", 4.0, -2.0);
+    LatticePresets::addHopping(&L, "A", "B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian HFull(IndexInfo, Storage, S);
+    HFull.prepare();
+    HFull.compute();
+    RealVectorType Spectrum = HFull.getEigenValues();
+
+    ComplexType G0, Chi0, G0Full, Chi0Full;
+    RealType E, EFull;
+
+    // A cutoff above the whole spectrum changes nothing
+    if (!run(IndexInfo, Storage, S, HFull, Spectrum.maxCoeff() - HFull.getGroundEnergy() + 1.0, G0Full, Chi0Full, EFull)) return EXIT_FAILURE;
+
+    // An energy window that keeps the one-particle excitations of the ground state but drops the highest states
+    if (!run(IndexInfo, Storage, S, HFull, 4.0, G0, Chi0, E)) return EXIT_FAILURE;
+
+    INFO("E = " << E << " (full " << EFull << ")");
+    INFO("G(0) = " << G0 << " (full " << G0Full << ")");
+    INFO("Chi(0,0,0) = " << Chi0 << " (full " << Chi0Full << ")");
+    if (std::abs(E - EFull) > 1e-6) return EXIT_FAILURE;
+    if (std::abs(G0 - G0Full) > 1e-6) return EXIT_FAILURE;
+    // The two-particle GF sees the dropped states, so only check that it has been computed in the reduced basis
+    if (!(std::abs(Chi0) > 0.0) || !(std::abs(Chi0) < 1e3)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
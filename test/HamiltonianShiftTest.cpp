@@ -0,0 +1,119 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/HamiltonianShiftTest.cpp
+** \brief Test of the shift of the Hamiltonian by the chemical potential and the magnetic field.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "DensityMatrix.h"
+
+using namespace Pomerol;
+
+void fill_lattice(Lattice &L, RealType mu, RealType h)
+{
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "A", 1.0, -0.5-mu);
+    LatticePresets::addCoulombS(&L, "B", 2.0, -1.0-mu);
+    LatticePresets::addHopping(&L, "A", "B", -1.0);
+    if (h != 0.0) {
+        LatticePresets::addMagnetization(&L, "A", h);
+        LatticePresets::addMagnetization(&L, "B", h);
+        };
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    RealType beta = 5.0, mu = 0.3, h = 0.2;
+
+    Lattice L;
+    fill_lattice(L, 0.0, 0.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare(world);
+    H.compute(world);
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    // -mu*N + h*(N_up - N_down)
+    Operator Shift = OperatorPresets::N(IndexInfo.getIndexSize())*(-mu);
+    const char* sites[] = {"A","B"};
+    for (int i=0; i<2; i++) {
+        Shift += OperatorPresets::n(IndexInfo.getIndex(sites[i],0,up))*h;
+        Shift -= OperatorPresets::n(IndexInfo.getIndex(sites[i],0,down))*h;
+        };
+    H.shift(Shift);
+    rho.update();
+
+    // Reference : the shifted Hamiltonian diagonalized from scratch
+    Lattice L2;
+    fill_lattice(L2, mu, h);
+    IndexHamiltonian Storage2(&L2,IndexInfo);
+    Storage2.prepare();
+    Hamiltonian H2(IndexInfo, Storage2, S);
+    H2.prepare(world);
+    H2.compute(world);
+    DensityMatrix rho2(S,H2,beta);
+    rho2.prepare();
+    rho2.compute();
+
+    INFO("Ground energy : " << H.getGroundEnergy() << " (reference " << H2.getGroundEnergy() << ")");
+    INFO("Occupancy : " << rho.getAverageOccupancy() << " (reference " << rho2.getAverageOccupancy() << ")");
+    if ((H.getEigenValues() - H2.getEigenValues()).cwiseAbs().maxCoeff() > 1e-12) return EXIT_FAILURE;
+    if (std::abs(H.getGroundEnergy() - H2.getGroundEnergy()) > 1e-12) return EXIT_FAILURE;
+    if (std::abs(rho.getAverageOccupancy() - rho2.getAverageOccupancy()) > 1e-12) return EXIT_FAILURE;
+    if (std::abs(rho.getAverageEnergy() - rho2.getAverageEnergy()) > 1e-12) return EXIT_FAILURE;
+
+    // A hopping is not a function of the conserved quantities
+    bool thrown = false;
+    try { H.shift(OperatorPresets::c_dag(0)*OperatorPresets::c(2)); }
+    catch (std::logic_error &e) { thrown = true; };
+    if (!thrown) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
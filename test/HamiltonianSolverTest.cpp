@@ -0,0 +1,146 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/HamiltonianSolverTest.cpp
+** \brief Test of the choice of the eigensolver for each part of the Hamiltonian.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+
+using namespace Pomerol;
+
+/** Diagonalizes the Hamiltonian of L with the default policy and with the dense solver only,
+ * checks that both give the same spectrum and that the eigenvectors are correct, and counts the solvers used for the parts. */
+bool check(Lattice &L, std::map<HamiltonianPart::SolverType, int> &Solvers)
+{
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    // The matrices of the parts in the FockState basis
+    Hamiltonian HFock(IndexInfo, Storage, S);
+    HFock.prepare();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute();
+
+    EigensolverPolicy DensePolicy;
+    DensePolicy.Decompose = false;
+    DensePolicy.Tridiagonal = false;
+    Hamiltonian HDense(IndexInfo, Storage, S);
+    HDense.setEigensolverPolicy(DensePolicy);
+    HDense.prepare();
+    HDense.compute();
+
+    Hamiltonian HValues(IndexInfo, Storage, S);
+    HValues.prepare();
+    HValues.computeEigenValues();
+
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++) {
+        const HamiltonianPart &Part = H.getPart(b);
+        if (HDense.getPart(b).getSolver() != HamiltonianPart::Dense && Part.getSize() > 1) return false;
+        Solvers[Part.getSolver()]++;
+        const RealVectorType &E = Part.getEigenValues();
+        if ((E - HDense.getPart(b).getEigenValues()).cwiseAbs().maxCoeff() > 1e-10) return false;
+        if ((HValues.getPart(b).getEigenValues() - E).cwiseAbs().maxCoeff() > 1e-10) return false;
+        for (long i=1; i<E.size(); i++) if (E(i) < E(i-1)) return false;
+
+        MatrixType V = Part.getMatrix();
+        MatrixType Residual = HFock.getPart(b).getMatrix() * V - V * E.cast<MelemType>().asDiagonal();
+        if (Residual.size() && Residual.cwiseAbs().maxCoeff() > 1e-10) return false;
+        MatrixType Overlap = V.adjoint() * V - MatrixType::Identity(V.cols(), V.cols());
+        if (Overlap.cwiseAbs().maxCoeff() > 1e-10) return false;
+        }
+    if (std::abs(H.getGroundEnergy() - HDense.getGroundEnergy()) > 1e-10) return false;
+    return true;
+}
+
+void print(const std::map<HamiltonianPart::SolverType, int> &Solvers)
+{
+    const char* Names[] = {"dense", "diagonal", "tridiagonal", "block diagonal", "warm start"};
+    for (std::map<HamiltonianPart::SolverType, int>::const_iterator it=Solvers.begin(); it!=Solvers.end(); it++)
+        INFO("  " << Names[it->first] << " : " << it->second << " parts");
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    // Atomic limit : all parts are diagonal in the FockState basis
+    Lattice L1;
+    L1.addSite(new Lattice::Site("A",1,2));
+    L1.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L1, "A", 4.0, -2.0);
+    LatticePresets::addCoulombS(&L1, "B", 3.0, -1.0);
+    std::map<HamiltonianPart::SolverType, int> Solvers1;
+    if (!check(L1, Solvers1)) return EXIT_FAILURE;
+    INFO("Atomic limit :");
+    print(Solvers1);
+    if (Solvers1.size() != 1 || Solvers1.count(HamiltonianPart::Diagonal) != 1) return EXIT_FAILURE;
+
+    // An open chain : the one-particle parts are tridiagonal, the parts of two particles with equal spins decompose
+    Lattice L2;
+    const char* Labels[] = {"A", "B", "C", "D"};
+    for (int i=0; i<4; i++) {
+        L2.addSite(new Lattice::Site(Labels[i],1,2));
+        LatticePresets::addCoulombS(&L2, Labels[i], 2.0, -1.0 + 0.1*i);
+        }
+    for (int i=0; i<3; i++) LatticePresets::addHopping(&L2, Labels[i], Labels[i+1], -1.0);
+    std::map<HamiltonianPart::SolverType, int> Solvers2;
+    if (!check(L2, Solvers2)) return EXIT_FAILURE;
+    INFO("Chain :");
+    print(Solvers2);
+    if (Solvers2[HamiltonianPart::Tridiagonal] == 0 || Solvers2[HamiltonianPart::Dense] == 0) return EXIT_FAILURE;
+
+    // Two decoupled dimers : the parts with particles on both dimers decompose into independent subblocks
+    Lattice L3;
+    for (int i=0; i<4; i++) {
+        L3.addSite(new Lattice::Site(Labels[i],1,2));
+        LatticePresets::addCoulombS(&L3, Labels[i], 3.0, -1.5 + 0.2*i);
+        }
+    LatticePresets::addHopping(&L3, "A", "B", -1.0);
+    LatticePresets::addHopping(&L3, "C", "D", -0.5);
+    std::map<HamiltonianPart::SolverType, int> Solvers3;
+    if (!check(L3, Solvers3)) return EXIT_FAILURE;
+    INFO("Two dimers :");
+    print(Solvers3);
+    if (Solvers3[HamiltonianPart::BlockDiagonal] == 0) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
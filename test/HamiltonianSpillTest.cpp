@@ -0,0 +1,122 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/HamiltonianSpillTest.cpp
+** \brief Test of the calculation with the eigenvectors kept in memory-mapped scratch files.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+
+using namespace Pomerol;
+
+RealType beta = 10.0;
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B",1,2));
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "A", 2.0, -1.0);
+    LatticePresets::addLevel(&L, "B", 0.3);
+    LatticePresets::addLevel(&L, "C", -0.3);
+    LatticePresets::addHopping(&L, "A", "B", 0.5);
+    LatticePresets::addHopping(&L, "A", "C", 0.5);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute();
+
+    Hamiltonian H2(IndexInfo, Storage, S);
+    H2.setScratchDirectory(".");
+    H2.prepare();
+    H2.compute();
+
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++) {
+        const HamiltonianPart &Part = H.getPart(b), &Part2 = H2.getPart(b);
+        if (!Part2.isSpilled() || Part.isSpilled()) return EXIT_FAILURE;
+        if ((Part.getMatrix() - Part2.getMatrix()).cwiseAbs().maxCoeff() > 1e-14) return EXIT_FAILURE;
+        Part2.evict();
+        if ((Part.getEigenState(0) - Part2.getEigenState(0)).cwiseAbs().maxCoeff() > 1e-14) return EXIT_FAILURE;
+        }
+
+    std::vector<Hamiltonian*> Hs;
+    Hs.push_back(&H);
+    Hs.push_back(&H2);
+    std::vector<ComplexVectorType> Gs;
+    for (size_t i=0; i<Hs.size(); i++) {
+        DensityMatrix rho(S,*Hs[i],beta);
+        rho.prepare();
+        rho.compute();
+        FieldOperatorContainer Operators(IndexInfo, S, *Hs[i]);
+        Operators.prepareAll();
+        Operators.computeAll();
+        GFContainer G(IndexInfo,S,*Hs[i],rho,Operators);
+        std::set<IndexCombination2> indices2;
+        indices2.insert(IndexCombination2(0,0));
+        G.prepareAll(indices2);
+        G.computeAll();
+        ComplexVectorType g(10);
+        for (int n=0; n<g.size(); n++) g(n) = G(0,0)(n);
+        Gs.push_back(g);
+        }
+    INFO("G(0) = " << Gs[1](0) << " (in memory " << Gs[0](0) << ")");
+    if ((Gs[0] - Gs[1]).cwiseAbs().maxCoeff() > 1e-14) return EXIT_FAILURE;
+
+    // The eigenvectors are read back for the warm start, the new ones are spilled again.
+    H2.update(Storage, true, world);
+    H2.compute();
+    if (!H2.getPart(BlockNumber(0)).isSpilled()) return EXIT_FAILURE;
+    if ((H.getEigenValues() - H2.getEigenValues()).cwiseAbs().maxCoeff() > 1e-12) return EXIT_FAILURE;
+
+    // Back to memory
+    H2.setScratchDirectory("");
+    if (H2.getPart(BlockNumber(0)).isSpilled()) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
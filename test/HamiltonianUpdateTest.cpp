@@ -0,0 +1,104 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+/** \file tests/HamiltonianUpdateTest.cpp
+** \brief Test of the refill of the Hamiltonian with new values of the terms.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include <boost/shared_ptr.hpp>
+
+using namespace Pomerol;
+
+void fill_lattice(Lattice &L, RealType U, RealType t)
+{
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -U/2);
+    LatticePresets::addCoulombS(&L, "B", 2.0, -1.0);
+    LatticePresets::addHopping(&L, "A", "B", t);
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    fill_lattice(L, 1.0, -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+    INFO("Lowest energy level at U=1 is " << H.getGroundEnergy());
+    if (std::abs(H.getGroundEnergy() + 2.8860009) > 1e-7) return EXIT_FAILURE;
+
+    // A new point of the sweep : only the coefficients of the terms change
+    Lattice L2;
+    fill_lattice(L2, 3.0, -0.5);
+    IndexHamiltonian Storage2(&L2,IndexInfo);
+    Storage2.prepare();
+
+    H.update(Storage2, false, world);
+    H.compute(world);
+
+    // Reference : the same point calculated from scratch
+    Hamiltonian H2(IndexInfo, Storage2, S);
+    H2.prepare();
+    H2.compute(world);
+
+    INFO("Lowest energy level at U=3 is " << H.getGroundEnergy() << " (reference " << H2.getGroundEnergy() << ")");
+    RealVectorType E1 = H.getEigenValues(), E2 = H2.getEigenValues();
+    if (E1.size() != E2.size()) return EXIT_FAILURE;
+    if ((E1-E2).cwiseAbs().maxCoeff() > 1e-12) return EXIT_FAILURE;
+    if (std::abs(H.getGroundEnergy() - H2.getGroundEnergy()) > 1e-12) return EXIT_FAILURE;
+
+    // Warm start from the eigenvectors of the same point
+    H.update(Storage2, true, world);
+    H.compute(world);
+    E1 = H.getEigenValues();
+    if ((E1-E2).cwiseAbs().maxCoeff() > 1e-12) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
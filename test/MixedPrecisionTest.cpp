@@ -0,0 +1,124 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2012 Andrey Antipov <antipov@ct-qmc.org>
+// Copyright (C) 2010-2012 Igor Krivenko <igor@shg.ru>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/MixedPrecisionTest.cpp
+** \brief Test of a Green's function calculation with the single precision storage of matrix elements.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 1.0;
+RealType mu = 0.5;
+
+bool compare(ComplexType a, ComplexType b)
+{
+    return abs(a-b) < 1e-5;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+
+    RealType OperatorError = Operators.getCreationOperator(0).getStorageError();
+    INFO("The largest error of the matrix elements of c^+_0 is " << OperatorError);
+    if (OperatorError > 1e-6 || OperatorError != Operators.getAnnihilationOperator(0).getStorageError()) return EXIT_FAILURE;
+
+    // The eigenvectors are needed only by the DensityMatrix after the rotation.
+    VectorType State = H.getPart(BlockNumber(4)).getEigenState(0);
+    RealType EigenvectorError = H.compress();
+    if (EigenvectorError > 1e-6 || !H.getPart(BlockNumber(4)).isCompressed()) return EXIT_FAILURE;
+    if ((State - H.getPart(BlockNumber(4)).getCompressedMatrix().col(0).cast<MelemType>()).cwiseAbs().maxCoeff() > EigenvectorError) return EXIT_FAILURE;
+
+    RealType beta = 10.0;
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    GreensFunction GF(S,H,Operators.getAnnihilationOperator(0), Operators.getCreationOperator(0), rho);
+    GF.prepare();
+    GF.compute();
+
+    // The reference is calculated in double precision, see GF2siteTest
+    ComplexVectorType G_ref(10);
+    G_ref << -2.53021005e-01*I,
+             -4.62090702e-01*I,
+             -4.32482782e-01*I,
+             -3.65598615e-01*I,
+             -3.07785174e-01*I,
+             -2.62894141e-01*I, 
+             -2.28274316e-01*I,
+             -2.01170772e-01*I,
+             -1.79539602e-01*I,
+             -1.61950993e-01*I;
+ 
+    bool result = true;
+    for(int n = 0; n<10; ++n) {
+        INFO(GF(n) << " == " << G_ref(n));
+        result = (result && compare(GF(n),G_ref(n)));
+        }
+    if (!result) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/MultiTemperatureTest.cpp
+** \brief Test of the Green's functions and the susceptibilities at several temperatures from a single set of transitions.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "Susceptibility.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType mu = 0.7;
+
+bool compare(ComplexType a, ComplexType b)
+{
+    return abs(a-b) < 1e-8 * (1.0 + abs(a));
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+
+    ParticleIndex up = IndexInfo.getIndex("A",0,1), dn = IndexInfo.getIndex("A",0,0);
+    QuadraticOperator Splus(IndexInfo, S, H, up, dn);
+    QuadraticOperator Sminus(IndexInfo, S, H, dn, up);
+    Splus.prepare();
+    Splus.compute();
+    Sminus.prepare();
+    Sminus.compute();
+
+    // The transitions are found once, at the first temperature
+    DensityMatrix rho0(S,H,1.0);
+    rho0.prepare();
+    rho0.compute();
+    GFContainer G0(IndexInfo,S,H,rho0,Operators);
+    G0.prepareAll();
+    G0.computeAll();
+    Susceptibility Chi0(S, H, Splus, Sminus, rho0);
+    Chi0.prepare();
+    Chi0.compute();
+
+    RealType betas[] = {1.0, 4.0, 30.0};
+    for (int b=0; b<3; b++) {
+        RealType beta = betas[b];
+        DensityMatrix rho(S,H,beta);
+        rho.prepare();
+        rho.compute();
+
+        // Reweighted from the transitions of G0 and Chi0
+        GFContainer G(G0, rho);
+        G.computeAll();
+        Susceptibility Chi(Chi0, rho);
+        Chi.compute();
+
+        // Computed from the operators
+        GFContainer GRef(IndexInfo,S,H,rho,Operators);
+        GRef.prepareAll();
+        GRef.computeAll();
+        Susceptibility ChiRef(S, H, Splus, Sminus, rho);
+        ChiRef.prepare();
+        ChiRef.compute();
+
+        INFO("beta = " << beta);
+        for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); i++)
+            for (ParticleIndex j=0; j<IndexInfo.getIndexSize(); j++)
+                for (int n=0; n<5; n++) {
+                    if (n == 0) INFO("G_" << i << j << "(0) = " << G(i,j)(n) << " == " << GRef(i,j)(n));
+                    if (!compare(G(i,j)(n), GRef(i,j)(n))) return EXIT_FAILURE;
+                    };
+        for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); i++)
+            if (!compare(G(i,i).of_tau(0.3*beta), GRef(i,i).of_tau(0.3*beta))) return EXIT_FAILURE;
+
+        for (int n=0; n<5; n++) {
+            INFO("chi(" << n << ") = " << Chi(n) << " == " << ChiRef(n));
+            if (!compare(Chi(n), ChiRef(n))) return EXIT_FAILURE;
+            };
+        if (!compare(Chi.of_tau(0.3*beta), ChiRef.of_tau(0.3*beta))) return EXIT_FAILURE;
+        };
+
+    // A density matrix, which retains more blocks than the one of the transitions, is rejected
+    DensityMatrix rhoTruncated(S,H,30.0);
+    rhoTruncated.prepare();
+    rhoTruncated.compute();
+    rhoTruncated.truncateBlocks(1e-8, false);
+    GFContainer GTruncated(IndexInfo,S,H,rhoTruncated,Operators);
+    GTruncated.prepareAll();
+    GTruncated.computeAll();
+    bool Rejected = false;
+    try { GFContainer G(GTruncated, rho0); }
+    catch (std::logic_error &e) { Rejected = true; }
+    if (!Rejected) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/PlannerTest.cpp
+** \brief Test of the estimates of the Planner against the actual calculation.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "TwoParticleGF.h"
+#include "Planner.h"
+
+#include <sstream>
+
+using namespace Pomerol;
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    L.addSite(new Lattice::Site("B",1,2));
+    L.addSite(new Lattice::Site("C",1,2));
+    LatticePresets::addCoulombS(&L, "A", 2.0, -1.0);
+    LatticePresets::addLevel(&L, "B", 0.3);
+    LatticePresets::addLevel(&L, "C", -0.3);
+    LatticePresets::addHopping(&L, "A", "B", 0.5);
+    LatticePresets::addHopping(&L, "A", "C", 0.5);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    ParticleIndex d0 = IndexInfo.getIndex("A",0,down), u0 = IndexInfo.getIndex("A",0,up);
+    std::set<ParticleIndex> f;
+    f.insert(d0);
+    f.insert(u0);
+    std::set<IndexCombination2> indices2;
+    indices2.insert(IndexCombination2(d0,d0));
+    std::set<IndexCombination4> indices4;
+    indices4.insert(IndexCombination4(d0,u0,d0,u0));
+
+    // The plan needs only the StatesClassification
+    Planner Plan(IndexInfo, S);
+    Plan.compute(f, indices2, indices4);
+    Plan.print(std::cout);
+    std::stringstream json;
+    Plan.printJSON(json);
+    INFO(json.str());
+    if (json.str().find("\"peak_bytes\"") == std::string::npos || json.str()[0] != '{') return EXIT_FAILURE;
+
+    const std::vector<Planner::BlockEstimate>& Blocks = Plan.getBlocks();
+    if (Blocks.size() != S.NumberOfBlocks()) return EXIT_FAILURE;
+    for (size_t b=0; b<Blocks.size(); b++) if (Blocks[b].Size != S.getBlockSize(Blocks[b].Block)) return EXIT_FAILURE;
+
+    // The actual calculation
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute();
+    DensityMatrix rho(S,H,10.0);
+    rho.prepare();
+    rho.compute();
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll(f);
+    Operators.computeAll();
+
+    const std::vector<Planner::OperatorEstimate>& OperatorEstimates = Plan.getOperators();
+    for (size_t i=0; i<OperatorEstimates.size(); i++) {
+        CreationOperator &CX = const_cast<CreationOperator&>(Operators.getCreationOperator(OperatorEstimates[i].Index));
+        if (CX.getParts().size() != OperatorEstimates[i].Parts) return EXIT_FAILURE;
+        RealType NonZeros = 0;
+        for (size_t p=0; p<CX.getParts().size(); p++) NonZeros += CX.getParts()[p]->getRowMajorValue().nonZeros();
+        INFO("c^+_" << OperatorEstimates[i].Index << " : " << NonZeros << " elements of at most " << OperatorEstimates[i].NonZeros);
+        if (NonZeros > OperatorEstimates[i].NonZeros) return EXIT_FAILURE;
+        }
+
+    TwoParticleGF Chi(S, H, Operators.getAnnihilationOperator(d0), Operators.getAnnihilationOperator(u0), 
+                      Operators.getCreationOperator(d0), Operators.getCreationOperator(u0), rho);
+    Chi.prepare();
+    Chi.compute();
+    const Planner::TwoParticleGFEstimate& ChiEstimate = Plan.getTwoParticleGFs()[0];
+    INFO("TwoParticleGF : " << Chi.parts.size() << " parts, " << ChiEstimate.Parts << " estimated");
+    if (Chi.parts.size() != ChiEstimate.Parts) return EXIT_FAILURE;
+    RealType Terms = 0;
+    for (size_t p=0; p<Chi.parts.size(); p++) Terms += Chi.parts[p]->getNonResonantTerms().size() + Chi.parts[p]->getResonantTerms().size();
+    INFO("TwoParticleGF : " << Terms << " terms of at most " << ChiEstimate.Terms);
+    if (Terms > ChiEstimate.Terms) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
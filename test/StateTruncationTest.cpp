@@ -0,0 +1,138 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/StateTruncationTest.cpp
+** \brief Test of the Green's functions and the two-particle GFs with the states truncated by the density matrix.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "TwoParticleGFContainer.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType mu = 1.0;
+RealType beta = 20.0;
+
+/** Compute the Green's functions and a few two-particle GFs with a given density matrix. */
+void computeValues(IndexClassification &IndexInfo, StatesClassification &S, const Hamiltonian &H, const DensityMatrix &rho,
+                   FieldOperatorContainer &Operators, std::vector<ComplexType> &Values)
+{
+    GFContainer G(IndexInfo,S,H,rho,Operators);
+    G.prepareAll();
+    G.computeAll();
+
+    std::set<IndexCombination4> Indices;
+    Indices.insert(IndexCombination4(0,1,0,1));
+    Indices.insert(IndexCombination4(0,0,0,0));
+    Indices.insert(IndexCombination4(0,2,0,2));
+    TwoParticleGFContainer Chi(IndexInfo,S,H,rho,Operators);
+    Chi.prepareAll(Indices);
+    Chi.computeAll();
+
+    Values.clear();
+    for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); i++)
+        for (int n=0; n<5; n++) Values.push_back(G(i,i)(n));
+    for (std::set<IndexCombination4>::const_iterator it=Indices.begin(); it!=Indices.end(); it++)
+        for (int n=-2; n<2; n++) {
+            Values.push_back(Chi(*it)(n,n,n));
+            Values.push_back(Chi(*it)(n,n+1,n-1));
+            Values.push_back(Chi(*it)(n,-n,0));
+            };
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+    std::vector<ComplexType> Full;
+    computeValues(IndexInfo, S, H, rho, Operators, Full);
+
+    DensityMatrix rhoTruncated(S,H,beta);
+    rhoTruncated.prepare();
+    rhoTruncated.compute();
+    rhoTruncated.truncateBlocks(1e-10);
+
+    // Some of the retained blocks have truncated states
+    size_t TruncatedStates = 0;
+    for (BlockNumber b=0; b<S.NumberOfBlocks(); b++)
+        if (rhoTruncated.isRetained(b)) {
+            const DensityMatrixPart& Part = rhoTruncated.getPart(b);
+            TruncatedStates += H.getPart(b).getNumberOfEigenStates() - Part.getRetainedStates().size();
+            for (size_t s=0; s<Part.getRetainedStates().size(); s++)
+                if (Part.getWeight(Part.getRetainedStates()[s]) <= 1e-10) return EXIT_FAILURE;
+            };
+    INFO("Truncated states in the retained blocks : " << TruncatedStates);
+    if (TruncatedStates == 0) return EXIT_FAILURE;
+
+    std::vector<ComplexType> Truncated;
+    computeValues(IndexInfo, S, H, rhoTruncated, Operators, Truncated);
+
+    for (size_t i=0; i<Full.size(); i++) {
+        INFO(Full[i] << " == " << Truncated[i]);
+        if (abs(Full[i] - Truncated[i]) > 1e-7 * (1.0 + abs(Full[i]))) return EXIT_FAILURE;
+        };
+
+    return EXIT_SUCCESS;
+}
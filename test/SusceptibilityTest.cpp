@@ -0,0 +1,179 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/SusceptibilityTest.cpp
+** \brief Test of the dynamical susceptibilities of quadratic operators.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperator.h"
+#include "DensityMatrix.h"
+#include "Susceptibility.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType mu = 0.7;
+RealType beta = 4.0;
+
+bool compare(ComplexType a, ComplexType b, RealType Tolerance = 1e-6)
+{
+    return abs(a-b) < Tolerance;
+}
+
+/** The Fourier transform of the imaginary time susceptibility by the Simpson rule. */
+ComplexType integrate(const Susceptibility& Chi, long MatsubaraNumber)
+{
+    const int N = 4000;
+    RealType h = beta / N;
+    ComplexType Sum = 0;
+    for (int k=0; k<=N; k++) {
+        RealType tau = k*h;
+        RealType Weight = (k == 0 || k == N) ? 1.0 : (k % 2 ? 4.0 : 2.0);
+        Sum += Weight * Chi.of_tau(tau) * exp(ComplexType(0.0, 2.0*M_PI*MatsubaraNumber*tau/beta));
+        }
+    return Sum * h / 3.0;
+}
+
+/** Check, that the Matsubara representation is the Fourier transform of the imaginary time one. */
+bool checkFourier(const Susceptibility& Chi)
+{
+    bool result = true;
+    for (long n=0; n<3; n++) {
+        INFO("chi(" << n << ") = " << Chi(n) << " == " << integrate(Chi, n));
+        result = result && compare(Chi(n), integrate(Chi, n), 1e-5);
+        }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    ParticleIndex up = IndexInfo.getIndex("A",0,1), dn = IndexInfo.getIndex("A",0,0), upB = IndexInfo.getIndex("B",0,1);
+
+    // Density-density : <T n(tau) n> at tau = 0 is <n n> = <n>
+    QuadraticOperator N(IndexInfo, S, H, up, up);
+    N.prepare();
+    N.compute();
+    Susceptibility ChiN(S, H, N, N, rho);
+    ChiN.prepare();
+    ChiN.compute();
+    INFO("<n n> = " << ChiN.of_tau(0) << " == " << rho.getAverageOccupancy(up));
+    if (!compare(ChiN.of_tau(0), rho.getAverageOccupancy(up))) return EXIT_FAILURE;
+    if (!checkFourier(ChiN)) return EXIT_FAILURE;
+    // The disconnected part contributes at the zero frequency only
+    ComplexType ChiN0 = ChiN(0), ChiN1 = ChiN(1);
+    ChiN.subtractDisconnected();
+    RealType n = rho.getAverageOccupancy(up);
+    if (!compare(ChiN(0), ChiN0 - beta*n*n) || !compare(ChiN(1), ChiN1) || !compare(ChiN.of_tau(0), n - n*n)) return EXIT_FAILURE;
+
+    // Transverse spin : <T S^+(tau) S^-> at tau = 0 is <n_up (1 - n_dn)>
+    QuadraticOperator Splus(IndexInfo, S, H, up, dn);
+    QuadraticOperator Sminus(IndexInfo, S, H, dn, up);
+    Splus.prepare();
+    Splus.compute();
+    Sminus.prepare();
+    Sminus.compute();
+    Susceptibility ChiPM(S, H, Splus, Sminus, rho);
+    ChiPM.prepare();
+    ChiPM.compute();
+    RealType SpinFlip = rho.getAverageOccupancy(up) - rho.getAverageDoubleOccupancy(up,dn);
+    INFO("<S^+ S^-> = " << ChiPM.of_tau(0) << " == " << SpinFlip);
+    if (!compare(ChiPM.of_tau(0), SpinFlip)) return EXIT_FAILURE;
+    if (!checkFourier(ChiPM)) return EXIT_FAILURE;
+
+    // Hopping : <T c^+_A c_B(tau) c^+_B c_A> at tau = 0 is <n_A (1 - n_B)>
+    QuadraticOperator Hop(IndexInfo, S, H, up, upB);
+    QuadraticOperator HopBack(IndexInfo, S, H, upB, up);
+    Hop.prepare();
+    Hop.compute();
+    HopBack.prepare();
+    HopBack.compute();
+    Susceptibility ChiHop(S, H, Hop, HopBack, rho);
+    ChiHop.prepare();
+    ChiHop.compute();
+    RealType Hopping = rho.getAverageOccupancy(up) - rho.getAverageDoubleOccupancy(up,upB);
+    INFO("<c^+_A c_B c^+_B c_A> = " << ChiHop.of_tau(0) << " == " << Hopping);
+    if (!compare(ChiHop.of_tau(0), Hopping)) return EXIT_FAILURE;
+    if (!checkFourier(ChiHop)) return EXIT_FAILURE;
+
+    // Longitudinal spin from a general operator, which maps each block to itself
+    Operator SzOp = OperatorPresets::n(up);
+    SzOp -= OperatorPresets::n(dn);
+    SzOp *= MelemType(0.5);
+    QuadraticOperator Sz(IndexInfo, S, H, SzOp);
+    Sz.prepare();
+    Sz.compute();
+    Susceptibility ChiZZ(S, H, Sz, Sz, rho);
+    ChiZZ.prepare();
+    ChiZZ.compute();
+    RealType SzSz = 0.25 * (rho.getAverageOccupancy(up) + rho.getAverageOccupancy(dn) - 2.0 * rho.getAverageDoubleOccupancy(up,dn));
+    INFO("<Sz Sz> = " << ChiZZ.of_tau(0) << " == " << SzSz);
+    if (!compare(ChiZZ.of_tau(0), SzSz)) return EXIT_FAILURE;
+    if (!checkFourier(ChiZZ)) return EXIT_FAILURE;
+    // The static susceptibility of a hermitian operator is real and positive
+    if (std::abs(std::imag(ChiZZ(0))) > 1e-10 || std::real(ChiZZ(0)) <= 0) return EXIT_FAILURE;
+    // The spin rotation symmetry of the Hubbard model
+    for (long n=0; n<3; n++) if (!compare(ChiPM(n), 2.0*ChiZZ(n))) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
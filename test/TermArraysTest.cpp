@@ -0,0 +1,122 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+/** \file tests/TermArraysTest.cpp
+** \brief Test of the frozen terms of the Green's functions and their evaluation at vectors of frequencies.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "HamiltonianPart.h"
+#include "Hamiltonian.h"
+#include "FieldOperatorContainer.h"
+#include "GFContainer.h"
+#include "TermArrays.h"
+
+#include<cstdlib>
+
+using namespace Pomerol;
+
+RealType U = 2.0;
+RealType mu = 0.7;
+RealType beta = 10.0;
+
+bool compare(ComplexType a, ComplexType b)
+{
+    return abs(a-b) < 1e-10 * (1.0 + abs(a));
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    // The similar terms are merged, the vanishing ones are dropped
+    std::vector<TermArrays::Term> Terms;
+    Terms.push_back(TermArrays::Term(0.5, ComplexType(0.25, 0.0)));
+    Terms.push_back(TermArrays::Term(-1.0, ComplexType(0.5, 0.1)));
+    Terms.push_back(TermArrays::Term(0.5 + 1e-12, ComplexType(0.25, 0.0)));
+    Terms.push_back(TermArrays::Term(2.0, ComplexType(1e-3, 0.0)));
+    Terms.push_back(TermArrays::Term(2.0, ComplexType(-1e-3, 0.0)));
+    TermArrays Arrays;
+    Arrays.assign(Terms, 1e-8);
+    if (Arrays.size() != 2 || Arrays.getPole(0) != -1.0 || !compare(Arrays.getResidue(1), 0.5)) return EXIT_FAILURE;
+    ComplexType z(0.3, 0.2);
+    if (!compare(Arrays(z), ComplexType(0.5, 0.1)/(z + 1.0) + 0.5/(z - 0.5))) return EXIT_FAILURE;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+    L.addSite(new Lattice::Site("B",1,2));
+    LatticePresets::addCoulombS(&L, "B", U, -mu);
+    LatticePresets::addHopping(&L, "A","B", -1.0);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare();
+    H.compute(world);
+    DensityMatrix rho(S,H,beta);
+    rho.prepare();
+    rho.compute();
+
+    FieldOperatorContainer Operators(IndexInfo, S, H);
+    Operators.prepareAll();
+    Operators.computeAll();
+    GFContainer G(IndexInfo,S,H,rho,Operators);
+    G.prepareAll();
+    G.computeAll();
+
+    // Matsubara frequencies and a real axis with a broadening
+    ComplexVectorType Frequencies(300);
+    for (long n=0; n<200; n++) Frequencies(n) = ComplexType(0.0, M_PI*(2*n-199)/beta);
+    for (long n=200; n<300; n++) Frequencies(n) = ComplexType(-4.0 + 0.08*(n-200), 0.05);
+
+    for (ParticleIndex i=0; i<IndexInfo.getIndexSize(); i++)
+        for (ParticleIndex j=0; j<IndexInfo.getIndexSize(); j++) {
+            const GreensFunction& GF = G(i,j);
+            ComplexVectorType Values = GF(Frequencies);
+            for (long n=0; n<Frequencies.size(); n++)
+                if (!compare(Values(n), GF(Frequencies(n)))) return EXIT_FAILURE;
+            if (!compare(GF(long(3)), GF(ComplexType(0.0, M_PI*7/beta)))) return EXIT_FAILURE;
+            // The residues sum up to the anticommutator of c_i and c^+_j
+            ComplexType Tail = GF(ComplexType(0.0, 1e7)) * ComplexType(0.0, 1e7);
+            INFO("z*G_" << i << j << "(z) = " << Tail);
+            if (abs(Tail - RealType(i == j)) > 1e-6) return EXIT_FAILURE;
+            };
+
+    return EXIT_SUCCESS;
+}
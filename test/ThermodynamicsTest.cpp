@@ -0,0 +1,102 @@
+//
+// This file is a part of pomerol - a scientific ED code for obtaining 
+// properties of a Hubbard model on a finite-size lattice 
+//
+// Copyright (C) 2010-2014 Andrey Antipov <Andrey.E.Antipov@gmail.com>
+// Copyright (C) 2010-2014 Igor Krivenko <Igor.S.Krivenko@gmail.com>
+//
+// pomerol is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// pomerol is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with pomerol.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/** \file tests/ThermodynamicsTest.cpp
+** \brief Test of the thermodynamic quantities of a Hubbard atom on a grid of temperatures.
+**
+** \author Andrey Antipov (Andrey.E.Antipov@gmail.com)
+*/
+
+#include "Misc.h"
+#include "Lattice.h"
+#include "LatticePresets.h"
+#include "Index.h"
+#include "IndexClassification.h"
+#include "Operator.h"
+#include "OperatorPresets.h"
+#include "IndexHamiltonian.h"
+#include "Symmetrizer.h"
+#include "StatesClassification.h"
+#include "Hamiltonian.h"
+#include "Thermodynamics.h"
+
+using namespace Pomerol;
+
+RealType U = 1.0;
+RealType mu = 0.4;
+
+bool compare(RealType a, RealType b)
+{
+    return std::abs(a-b) < 1e-10*std::max(1.0, std::abs(b));
+}
+
+int main(int argc, char* argv[])
+{
+    boost::mpi::environment env(argc,argv);
+    boost::mpi::communicator world;
+
+    Lattice L;
+    L.addSite(new Lattice::Site("A",1,2));
+    LatticePresets::addCoulombS(&L, "A", U, -mu);
+
+    IndexClassification IndexInfo(L.getSiteMap());
+    IndexInfo.prepare();
+    IndexHamiltonian Storage(&L,IndexInfo);
+    Storage.prepare();
+    Symmetrizer Symm(IndexInfo, Storage);
+    Symm.compute();
+    StatesClassification S(IndexInfo,Symm);
+    S.compute();
+
+    Hamiltonian H(IndexInfo, Storage, S);
+    H.prepare(world);
+    H.computeEigenValues(world);
+
+    std::vector<RealType> Betas;
+    for (int i=1; i<=50; i++) Betas.push_back(0.5*i);
+
+    Thermodynamics T(IndexInfo, S, H, Betas);
+    T.compute();
+
+    for (size_t i=0; i<Betas.size(); i++) {
+        RealType beta = Betas[i];
+        // Levels : 0, -mu (twice), U-2mu
+        RealType w0 = 1.0, w1 = exp(beta*mu), w2 = exp(-beta*(U-2*mu));
+        RealType Z = w0 + 2*w1 + w2;
+        RealType E = (-2*mu*w1 + (U-2*mu)*w2)/Z;
+        RealType E2 = (2*mu*mu*w1 + (U-2*mu)*(U-2*mu)*w2)/Z;
+        RealType N = (2*w1 + 2*w2)/Z;
+        RealType N2 = (2*w1 + 4*w2)/Z;
+        RealType Sz2 = 0.5*w1/Z;
+        if (!compare(T.getLogPartitionFunction()(i), log(Z)) ||
+            !compare(T.getEnergy()(i), E) ||
+            !compare(T.getSpecificHeat()(i), beta*beta*(E2-E*E)) ||
+            !compare(T.getEntropy()(i), log(Z) + beta*E) ||
+            !compare(T.getOccupancy()(i), N) ||
+            !compare(T.getChargeSusceptibility()(i), beta*(N2-N*N)) ||
+            !compare(T.getSpinSusceptibility()(i), beta*Sz2)) {
+            ERROR("Mismatch at beta = " << beta);
+            return EXIT_FAILURE;
+            }
+        }
+    INFO("C(beta) = " << T.getSpecificHeat().transpose());
+    return EXIT_SUCCESS;
+}